@@ -13,7 +13,7 @@
  * 64bit arch timer.CNTPCT
  * Freq = 24000000Hz
  */
-static inline u64 get_arch_counter(void)
+u64 get_arch_counter(void)
 {
 	u32 low=0, high = 0;
 	asm volatile("mrrc p15, 0, %0, %1, c14"
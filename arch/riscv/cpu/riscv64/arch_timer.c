@@ -13,7 +13,7 @@
  * 64bit arch timer.CNTPCT
  * Freq = 24000000Hz
  */
-static inline u64 get_arch_counter(void)
+u64 get_arch_counter(void)
 {
 	 unsigned long long cnt = 0;
 
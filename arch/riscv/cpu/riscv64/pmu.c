@@ -0,0 +1,74 @@
+/*
+ * SPDX-License-Identifier:	GPL-2.0+
+ *
+ * c906 hardware performance monitor: cycles, instructions retired and L1
+ * misses, summed per scope of the boot. The c906 has no stall events,
+ * cycles per instruction against the misses stands in for them.
+ */
+
+#include <common.h>
+#include <pmu.h>
+#include <asm/csr.h>
+
+static struct pmu_scope pmu_total = { .name = "total" };
+static struct pmu_scope *pmu_scopes, **pmu_tail = &pmu_scopes;
+
+void pmu_init(void)
+{
+	csr_write(CSR_MHPMEVENT4, HPM_L1I_MISS);
+	csr_write(CSR_MHPMEVENT15, HPM_L1D_READ_MISS);
+	csr_write(CSR_MHPMEVENT17, HPM_L1D_WRITE_MISS);
+	csr_clear(CSR_MXSTATUS, MXSTATUS_PMDM);
+	csr_write(CSR_MCOUNTINHIBIT, 0);
+	pmu_begin(&pmu_total);
+}
+
+void pmu_read(u64 *count)
+{
+	count[PMU_CYCLES]         = csr_read(CSR_MCYCLE);
+	count[PMU_INSTRET]        = csr_read(CSR_MINSTRET);
+	count[PMU_L1I_MISS]       = csr_read(CSR_MHPMCOUNTER4);
+	count[PMU_L1D_READ_MISS]  = csr_read(CSR_MHPMCOUNTER15);
+	count[PMU_L1D_WRITE_MISS] = csr_read(CSR_MHPMCOUNTER17);
+}
+
+void pmu_begin(struct pmu_scope *scope)
+{
+	pmu_read(scope->start);
+}
+
+void pmu_end(struct pmu_scope *scope)
+{
+	u64 count[PMU_NR];
+	int i;
+
+	pmu_read(count);
+	for (i = 0; i < PMU_NR; i++)
+		scope->sum[i] += count[i] - scope->start[i];
+	if (!scope->calls++) {
+		*pmu_tail = scope;
+		pmu_tail = &scope->next;
+	}
+}
+
+static void pmu_print(struct pmu_scope *scope)
+{
+	u64 *c = scope->sum;
+	u64 cpi = c[PMU_INSTRET] ? c[PMU_CYCLES] * 100 / c[PMU_INSTRET] : 0;
+
+	printf("%16s %6d %12lu %12lu %4lu.%02lu %10lu %10lu %10lu\n", scope->name, scope->calls,
+	       (ulong)c[PMU_CYCLES], (ulong)c[PMU_INSTRET], (ulong)cpi / 100, (ulong)cpi % 100,
+	       (ulong)c[PMU_L1I_MISS], (ulong)c[PMU_L1D_READ_MISS], (ulong)c[PMU_L1D_WRITE_MISS]);
+}
+
+void pmu_report(void)
+{
+	struct pmu_scope *scope;
+
+	pmu_end(&pmu_total);
+	printf("%16s %6s %12s %12s %7s %10s %10s %10s\n", "pmu scope", "calls", "cycles",
+	       "instret", "cpi", "l1i miss", "l1d rmiss", "l1d wmiss");
+	/* in the order they were first ended, so the total comes last */
+	for (scope = pmu_scopes; scope; scope = scope->next)
+		pmu_print(scope);
+}
@@ -0,0 +1,88 @@
+/*
+ * SPDX-License-Identifier:	GPL-2.0+
+ *
+ * sampling profiler: the CLINT machine timer interrupts boot0 and mepc is
+ * counted per 16 bytes of boot0 text. The histogram lives in SRAM past
+ * the boot0 image, as DRAM isn't up yet for much of what is worth sampling.
+ */
+
+#include <common.h>
+#include <profile.h>
+#include <asm/csr.h>
+#include <asm/io.h>
+
+#define PROFILE_SHIFT		4
+#define PROFILE_BUCKETS		(CFG_SYS_INIT_RAM_SIZE >> PROFILE_SHIFT)
+#define PROFILE_PERIOD		(24000000 / CFG_BOOT0_PROFILE_HZ)
+
+void profile_vector(void);
+void profile_trap(ulong cause, ulong epc);
+
+static u32 *const profile_hist = (u32 *)CONFIG_BOOT0_PROFILE_BASE;
+static u32 profile_other;	/* samples outside boot0 text */
+static ulong profile_mtvec;
+static int profile_on;
+
+static void profile_arm(u64 when)
+{
+	/* hi first so the compare can't match half written */
+	writel(0xffffffff, SUNXI_CLINT_MTIMECMPH);
+	writel((u32)when, SUNXI_CLINT_MTIMECMPL);
+	writel(when >> 32, SUNXI_CLINT_MTIMECMPH);
+}
+
+void profile_trap(ulong cause, ulong epc)
+{
+	ulong off = epc - CONFIG_BOOT0_RUN_ADDR;
+
+	if (cause != (SCAUSE_IRQ_FLAG | IRQ_M_TIMER)) {
+		printf("trap: mcause %lx mepc %lx\n", cause, epc);
+		console_flush();
+		while (1)
+			;
+	}
+	if (off < CFG_SYS_INIT_RAM_SIZE)
+		profile_hist[off >> PROFILE_SHIFT]++;
+	else
+		profile_other++;
+	profile_arm(get_arch_counter() + PROFILE_PERIOD);
+}
+
+void profile_start(void)
+{
+	memset(profile_hist, 0, PROFILE_BUCKETS * sizeof(*profile_hist));
+	profile_other = 0;
+	profile_mtvec = csr_read(CSR_MTVEC);
+	csr_write(CSR_MTVEC, (ulong)profile_vector);
+	profile_arm(get_arch_counter() + PROFILE_PERIOD);
+	csr_set(CSR_MIE, MIE_MTIE);
+	csr_set(CSR_MSTATUS, SR_MIE);
+	profile_on = 1;
+}
+
+/* before leaving boot0, the next stage finds interrupts as boot0 did */
+void profile_stop(void)
+{
+	if (!profile_on)
+		return;
+	csr_clear(CSR_MSTATUS, SR_MIE);
+	csr_clear(CSR_MIE, MIE_MTIE);
+	profile_arm(~0ULL);
+	csr_write(CSR_MTVEC, profile_mtvec);
+	profile_on = 0;
+}
+
+/* the lines tools/boot0_profile.py reads, out of a UART log */
+void profile_dump(void)
+{
+	int i;
+
+	profile_stop();
+	printf("profile: hz %d text %x shift %d other %d\n", CFG_BOOT0_PROFILE_HZ,
+	       CONFIG_BOOT0_RUN_ADDR, PROFILE_SHIFT, profile_other);
+	for (i = 0; i < PROFILE_BUCKETS; i++)
+		if (profile_hist[i])
+			printf("profile: %x %d\n", CONFIG_BOOT0_RUN_ADDR + (i << PROFILE_SHIFT),
+			       profile_hist[i]);
+	printf("profile: end\n");
+}
@@ -0,0 +1,44 @@
+/*
+ * SPDX-License-Identifier:	GPL-2.0+
+ *
+ * Pick the vector kernels for the core boot0 runs on, see asm/vector.h.
+ * A c906 doesn't set misa.V for its RVV 0.7.1 unit; it is found by the
+ * T-Head vendor id and an mstatus.VS, at the 0.7.1 place, that can be set.
+ */
+
+#include <common.h>
+#include <asm/csr.h>
+#include <asm/vector.h>
+
+void *(*vec_memcpy)(void *dst, const void *src, size_t n);
+void *(*vec_memset)(void *s, int c, size_t n);
+u32 (*vec_addsum)(u32 sum, const void *buf, u32 size);
+void (*vec_dram_fill)(u32 *addr, u32 patt, ulong n);
+u32 (*vec_dram_check)(const u32 *addr, u32 patt, ulong n);
+
+static int thead_vector(void)
+{
+	if (csr_read(CSR_MVENDORID) != MVENDORID_THEAD)
+		return 0;
+	/* reserved in RVV 1.0 mstatus, reads back 0 there */
+	csr_set(CSR_MSTATUS, SR_VS_THEAD_INITIAL);
+	return !!(csr_read(CSR_MSTATUS) & SR_VS_THEAD);
+}
+
+void vector_init(void)
+{
+	if (thead_vector()) {
+		vec_memcpy     = thead_rvv_memcpy;
+		vec_memset     = thead_rvv_memset;
+		vec_addsum     = thead_rvv_addsum;
+		vec_dram_fill  = thead_rvv_dram_fill;
+		vec_dram_check = thead_rvv_dram_check;
+	} else if (csr_read(CSR_MISA) & MISA_V) {
+		csr_set(CSR_MSTATUS, SR_VS_INITIAL);
+		vec_memcpy     = rvv_memcpy;
+		vec_memset     = rvv_memset;
+		vec_addsum     = rvv_addsum;
+		vec_dram_fill  = rvv_dram_fill;
+		vec_dram_check = rvv_dram_check;
+	}
+}
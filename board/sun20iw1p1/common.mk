@@ -14,5 +14,5 @@ CFG_BOOT0_RUN_ADDR=0x20000
 CFG_SYS_INIT_RAM_SIZE=0x10000
 CFG_FES1_RUN_ADDR=0x28000
 CFG_SBOOT_RUN_ADDR=0x20480
-CFG_SUNXI_MEMOP=y
 CFG_ARCH_RISCV=y
+CFG_BOOT0_TIMELINE=y
@@ -5,3 +5,12 @@
 include $(TOPDIR)/board/$(PLATFORM)/common.mk
 
 CFG_SUNXI_SDMMC =y
+CFG_SUNXI_DMA =y
+CFG_SUNXI_DMA_MEMCPY =y
+#check the sha256 of toc1 items and boot manifest entries that have one
+CFG_SUNXI_SHA256 =y
+#read toc1 items straight to their run_addr
+ifneq ($(CFG_EXT2_LOADER),y)
+CFG_TOC1_DIRECT_LOAD =y
+endif
+CFG_BOOT0_CONSOLE_RING =y
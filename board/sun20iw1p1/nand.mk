@@ -7,3 +7,5 @@ include $(TOPDIR)/board/$(PLATFORM)/common.mk
 CFG_SUNXI_NAND =y
 CFG_SUNXI_SPINAND =y
 CFG_SUNXI_DMA =y
+CFG_SUNXI_DMA_MEMCPY =y
+CFG_BOOT0_CONSOLE_RING =y
@@ -7,5 +7,13 @@ include $(TOPDIR)/board/$(PLATFORM)/common.mk
 CFG_SUNXI_SPI =y
 CFG_SUNXI_DMA =y
 CFG_SPI_USE_DMA =y
+CFG_SUNXI_DMA_MEMCPY =y
 CFG_SUNXI_SPINOR =y
 CFG_SPINOR_UBOOT_OFFSET=128
+#read toc1 items straight to their run_addr
+CFG_TOC1_DIRECT_LOAD =y
+#check the sha256 of toc1 items that have one
+CFG_SUNXI_SHA256 =y
+#lz4 compressed toc1 items, flash reads are the bottleneck
+CFG_SUNXI_LZ4 =y
+CFG_BOOT0_CONSOLE_RING =y
@@ -13,6 +13,30 @@
 #include <private_boot0.h>
 #include <private_uboot.h>
 #include <arch/uart.h>
+#ifdef CFG_RISCV_VECTOR
+#include <asm/vector.h>
+#endif
+
+/* add the size/4 words at buf to sum, for checksums computed piecewise */
+u32 add_sum_update(u32 sum, const void *buf, u32 size)
+{
+	const u32 *p = (const u32 *)buf;
+	u32 count = size >> 2;
+
+#ifdef CFG_RISCV_VECTOR
+	if (vec_addsum && size >= VEC_MIN_BYTES && !((ulong)buf & 3))
+		return vec_addsum(sum, buf, size);
+#endif
+	while (count >= 4) {
+		sum += p[0] + p[1] + p[2] + p[3];
+		p += 4;
+		count -= 4;
+	}
+	while (count--)
+		sum += *p++;
+
+	return sum;
+}
 
 #ifdef CFG_SUNXI_USE_NEON
 /*stdint.h included by arm_neon.h has conflict on uintptr_t with linux/types.h, undef it here*/
@@ -64,8 +88,6 @@ int verify_addsum(void *mem_base, u32 size)
 /* check: 0-success  -1:fail */
 int verify_addsum(void *mem_base, u32 size)
 {
-	u32 *buf;
-	u32 count;
 	u32 src_sum;
 	u32 sum;
 	sbrom_toc1_head_info_t *bfh;
@@ -74,20 +96,7 @@ int verify_addsum(void *mem_base, u32 size)
 	/*generate checksum*/
 	src_sum = bfh->add_sum;
 	bfh->add_sum = STAMP_VALUE;
-	count = size >> 2;
-	sum = 0;
-	buf = (u32 *)mem_base;
-	do
-	{
-		sum += *buf++;
-		sum += *buf++;
-		sum += *buf++;
-		sum += *buf++;
-	}while( ( count -= 4 ) > (4-1) );
-
-	while( count-- > 0 )
-		sum += *buf++;
-
+	sum = add_sum_update(0, mem_base, size);
 	bfh->add_sum = src_sum;
 
 //	printf("sum=%x\n", sum);
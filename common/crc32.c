@@ -47,19 +47,71 @@ static const uint32_t crc32_table[256] = {
 	0xB40BBE37, 0xC30C8EA1, 0x5A05DF1B, 0x2D02EF8D
 };
 
-static uint32_t crc32_0(const uint8_t *data, uint32_t length)
+/*
+ * Slicing-by-8: tables 1..7 give the CRC of a byte followed by 1..7 zero
+ * bytes, so eight bytes are folded in with eight lookups. They take 7K and
+ * boot0 only has 64K of SRAM, so crc32_init() builds them in the heap right
+ * after malloc_init(), before any malloc_mark() that could take them back;
+ * without it crc32() stays byte at a time. There is no vector version:
+ * the c906's RVV 0.7.1 has no carry-less multiply to fold with, and table
+ * lookups don't vectorise over a byte stream that depends on the last.
+ */
+static uint32_t (*crc32_slice)[256];
+
+void crc32_init(void)
 {
-	register uint32_t crc = 0xFFFFFFFF;
+	uint32_t (*t)[256];
+	int i, k;
 
-	while (length--) {
-		crc = ((crc >> 8) & 0x00FFFFFF) ^
-		      crc32_table[(crc ^ *data++) & 0x000000FF];
+	if (crc32_slice)
+		return;
+	t = malloc(7 * sizeof(*t));
+	if (!t)
+		return;
+	for (i = 0; i < 256; i++) {
+		t[0][i] = (crc32_table[i] >> 8) ^ crc32_table[crc32_table[i] & 0xFF];
+		for (k = 1; k < 7; k++)
+			t[k][i] = (t[k - 1][i] >> 8) ^ crc32_table[t[k - 1][i] & 0xFF];
 	}
+	crc32_slice = t;
+}
 
-	return (crc ^ 0xFFFFFFFF);
+static uint32_t crc32_bytes(uint32_t crc, const uint8_t *data, uint32_t length)
+{
+	while (length--)
+		crc = (crc >> 8) ^ crc32_table[(crc ^ *data++) & 0xFF];
+
+	return crc;
 }
 
+/* crc is the result of the previous call, 0 to start */
 uint32_t crc32(uint32_t crc, const uint8_t *buf, uint len)
 {
-	return crc32_0(buf, len);
+	const uint32_t (*t)[256];
+	uint32_t n;
+
+	if (!buf)
+		return 0;
+
+	crc = ~crc;
+	t = (const uint32_t (*)[256])crc32_slice;
+	if (t && len >= 16) {
+		n = -(ulong)buf & 7;
+		crc = crc32_bytes(crc, buf, n);
+		buf += n;
+		len -= n;
+		for (; len >= 8; buf += 8, len -= 8) {
+			uint64_t v = *(const uint64_t *)buf;
+			uint32_t lo = (uint32_t)v ^ crc;
+			uint32_t hi = v >> 32;
+
+			crc = t[6][lo & 0xFF] ^ t[5][(lo >> 8) & 0xFF] ^
+			      t[4][(lo >> 16) & 0xFF] ^ t[3][lo >> 24] ^
+			      t[2][hi & 0xFF] ^ t[1][(hi >> 8) & 0xFF] ^
+			      t[0][(hi >> 16) & 0xFF] ^ crc32_table[hi >> 24];
+		}
+	}
+	crc = crc32_bytes(crc, buf, len);
+
+	return ~crc;
 }
@@ -6,6 +6,9 @@
 #include <common.h>
 /* #include <watchdog.h> */
 #include "LzmaDec.h"
+#ifdef CFG_RISCV_XTHEAD
+#include <asm/xthead.h>
+#endif
 
 /* #include <linux/string.h> */
 
@@ -48,7 +51,28 @@
 		i = (i + i) + 1;                                               \
 		A1;                                                            \
 	}
+#ifdef CFG_RISCV_XTHEAD
+/*
+ * the literal and bit tree bits are a coin toss for the branch predictor,
+ * with th.mvnez each select is a single instruction
+ */
+#define GET_BIT(p, i)                                                          \
+	{                                                                      \
+		unsigned long bit;                                             \
+		ttt = *(p);                                                    \
+		NORMALIZE;                                                     \
+		bound = (range >> kNumBitModelTotalBits) * ttt;                \
+		bit   = code >= bound;                                         \
+		range = xthead_select(bit, range - bound, bound);              \
+		code  = xthead_select(bit, code - bound, code);                \
+		*(p)  = (CLzmaProb)xthead_select(                              \
+			bit, ttt - (ttt >> kNumMoveBits),                      \
+			ttt + ((kBitModelTotal - ttt) >> kNumMoveBits));       \
+		i = (i + i) + bit;                                             \
+	}
+#else
 #define GET_BIT(p, i) GET_BIT2(p, i, ;, ;)
+#endif
 
 #define TREE_GET_BIT(probs, i)                                                 \
 	{                                                                      \
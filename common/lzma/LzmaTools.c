@@ -32,7 +32,7 @@
 #include "LzmaTools.h"
 #include "LzmaDec.h"
 
-#define debug printf
+#define debug pr_debug
 /* #include <linux/string.h> */
 /* #include <malloc.h> */
 
@@ -9,17 +9,61 @@
 
 #include <common.h>
 
-struct alloc_struct_t
+/*
+ * The heap is a bump arena over [start, start + size) with power of two
+ * size-class pools in front of it. Blocks up to MALLOC_POOL_MAX are rounded
+ * up to their class and go back on the class free list when freed, so the
+ * zlib/LZMA state a decoder allocates is recycled by the next run. Larger
+ * blocks are cut straight from the arena and only given back when they are
+ * the last block allocated, or by malloc_release(). Every block in use
+ * carries the number of the malloc() that returned it, 0 once it is freed,
+ * which is what malloc_release() goes by.
+ */
+struct alloc_head_t
+{
+	__u32 size;                         /* usable size of the block          */
+	__u32 magic;
+	__u32 cls;                          /* size class, MALLOC_CLASSES = none */
+	__u32 seq;                          /* allocation number, 0 when free   */
+};
+
+struct alloc_free_t
 {
-	phys_addr_t address;                      //申请内存的地址
-    __u32 size;                         //分配的内存大小，用户实际得到的内存大小
-    __u32 o_size;                       //用户申请的内存大小
-    struct alloc_struct_t *next;
+	struct alloc_free_t *next;
 };
 
-#define MY_BYTE_ALIGN(x)                ( ( (x + 15)/16) * 16)             /* alloc based on 1k byte */
+#define MY_BYTE_ALIGN(x)                ( ( (x + 15)/16) * 16)             /* alloc based on 16 byte */
+#define MALLOC_MAGIC                    0x6d616c63
+#define MALLOC_POOL_SHIFT               5                                  /* smallest class 32 bytes */
+#define MALLOC_CLASSES                  12                                 /* largest class 64K       */
+#define MALLOC_POOL_MAX                 (1U << (MALLOC_POOL_SHIFT + MALLOC_CLASSES - 1))
+
+static phys_addr_t heap_start, heap_cur, heap_end;
+static struct alloc_free_t *heap_pool[MALLOC_CLASSES];
+static __u32 heap_seq;
+
+static int malloc_class(__u32 num_bytes)
+{
+	int cls = 0;
 
-static struct alloc_struct_t boot_heap_head, boot_heap_tail;
+	while ((1U << (MALLOC_POOL_SHIFT + cls)) < num_bytes)
+		cls++;
+
+	return cls;
+}
+
+static struct alloc_head_t *malloc_head(void *p)
+{
+	struct alloc_head_t *head = (struct alloc_head_t *)p - 1;
+
+	if ((phys_addr_t)head < heap_start || (phys_addr_t)p > heap_cur ||
+	    head->magic != MALLOC_MAGIC) {
+		printf("malloc: bad pointer %lx\n", (ulong)p);
+		return NULL;
+	}
+
+	return head;
+}
 /*
 *********************************************************************************************************
 *                       CREATE HEAP
@@ -35,16 +79,16 @@ static struct alloc_struct_t boot_heap_head, boot_heap_tail;
 
 __s32 malloc_init(__u32 pHeapHead, __u32 nHeapSize)
 {
-	return 0;
-
+	int i;
 
-    boot_heap_head.size    = boot_heap_tail.size = 0;
-    boot_heap_head.address = pHeapHead;
-    boot_heap_tail.address = pHeapHead + nHeapSize;
-    boot_heap_head.next    = &boot_heap_tail;
-    boot_heap_tail.next    = 0;
+	heap_start = MY_BYTE_ALIGN((phys_addr_t)pHeapHead);
+	heap_cur   = heap_start;
+	heap_end   = (phys_addr_t)pHeapHead + nHeapSize;
+	heap_seq   = 0;
+	for (i = 0; i < MALLOC_CLASSES; i++)
+		heap_pool[i] = NULL;
 
-    return 0;
+	return 0;
 }
 
 /*
@@ -55,129 +99,96 @@ __s32 malloc_init(__u32 pHeapHead, __u32 nHeapSize)
 *
 * Aguments   : num_bytes    the size of the buffer need malloc;
 *
-* Returns    : the po__s32er to buffer has malloc.
+* Returns    : the pointer to buffer has malloc, 0 before malloc_init() or when the heap is full.
 *********************************************************************************************************
 */
 void *malloc(__u32 num_bytes)
 {
-	return 0;
-
-
-
-
-    struct alloc_struct_t *ptr, *newptr;
-    __u32  actual_bytes;
-
-    if (!num_bytes) return 0;
-
-    actual_bytes = MY_BYTE_ALIGN(num_bytes);    /* translate the byte count to size of long type       */
-
-    ptr = &boot_heap_head;                      /* scan from the boot_heap_head of the heap            */
-
-    while (ptr && ptr->next)                    /* look for enough memory for alloc                    */
-    {
-        if (ptr->next->address >= (ptr->address + ptr->size +                                          \
-                2 * sizeof(struct alloc_struct_t) + actual_bytes))
-        {
-            break;
-        }
-                                                /* find enough memory to alloc                         */
-        ptr = ptr->next;
-    }
-
-    if (!ptr->next)
-    {
-        return 0;                   /* it has reached the boot_heap_tail of the heap now              */
-    }
-
-    newptr = (struct alloc_struct_t *)(ptr->address + ptr->size);
-                                                /* create a new node for the memory block             */
-    if (!newptr)
-    {
-        return 0;                               /* create the node failed, can't manage the block     */
-    }
-
-    /* set the memory block chain, insert the node to the chain */
-    newptr->address = ptr->address + ptr->size + sizeof(struct alloc_struct_t);
-    newptr->size    = actual_bytes;
-    newptr->o_size  = num_bytes;
-    newptr->next    = ptr->next;
-    ptr->next       = newptr;
-
-    return (void *)newptr->address;
+	struct alloc_head_t *head;
+	struct alloc_free_t *blk;
+	__u32  actual_bytes;
+	int    cls = MALLOC_CLASSES;
+
+	if (!num_bytes) return 0;
+
+	if (num_bytes <= MALLOC_POOL_MAX) {
+		cls = malloc_class(num_bytes);
+		actual_bytes = 1U << (MALLOC_POOL_SHIFT + cls);
+		blk = heap_pool[cls];
+		if (blk) {
+			heap_pool[cls] = blk->next;
+			((struct alloc_head_t *)blk - 1)->seq = ++heap_seq;
+			return blk;
+		}
+	} else {
+		actual_bytes = MY_BYTE_ALIGN(num_bytes);
+	}
+
+	if (heap_end - heap_cur < sizeof(struct alloc_head_t) + actual_bytes) {
+		printf("malloc: no room for %d bytes\n", num_bytes);
+		return 0;
+	}
+
+	head = (struct alloc_head_t *)heap_cur;
+	head->size  = actual_bytes;
+	head->magic = MALLOC_MAGIC;
+	head->cls   = cls;
+	head->seq   = ++heap_seq;
+	heap_cur += sizeof(struct alloc_head_t) + actual_bytes;
+
+	return head + 1;
 }
 /*
 *********************************************************************************************************
-*                       MALLOC BUFFER FROM HEAP
+*                       REALLOC BUFFER FROM HEAP
 *
-* Description: malloc a buffer from heap.
+* Description: resize a buffer from heap, keeping its content.
 *
-* Aguments   : num_bytes    the size of the buffer need malloc;
+* Aguments   : p            the buffer, or 0 to malloc a new one;
+*              num_bytes    the new size of the buffer;
 *
-* Returns    : the po__s32er to buffer has malloc.
+* Returns    : the pointer to the resized buffer, 0 if it can't grow (p is still valid then).
 *********************************************************************************************************
 */
 void *realloc(void *p, __u32 num_bytes)
 {
-	return 0;
-
-
-
-
-    struct alloc_struct_t *ptr, *prev;
-    void   *tmp;
-    __u32  actual_bytes;
-
-    if(!p)
-    {
-        return malloc(num_bytes);             /* 如果传进的指针是空，则按照传进的字节数申请内存    */
-    }
-    if (!num_bytes)
-    {
-        return p;                                   /* 如果申请追加的内存字节数是0，则直接返回当前的指针 */
-    }
-
-    ptr = &boot_heap_head;                          /* look for the node which po__s32 this memory block                   */
-    while (ptr && ptr->next)
-    {
-		if (ptr->next->address == (phys_addr_t)p)
-            break;                                  /* find the node which need to be release                              */
-        ptr = ptr->next;
-    }
-
-    //此时，ptr指向的是用户指针的前一个节点
-    prev = ptr;
-    ptr  = ptr->next;
-
-    if(!ptr)
-    {
-        return 0;                                   /* 如果没有找到用户传进的地址         */
-    }
-    //用ptr指向用户节点
-    actual_bytes = MY_BYTE_ALIGN(ptr->o_size + num_bytes);
-    if(actual_bytes == ptr->size)
-    {
-        return p;
-    }
-
-    if (ptr->next->address >= (ptr->address + actual_bytes +                                          \
-                2 * sizeof(struct alloc_struct_t)))
-    {
-        ptr->size    = actual_bytes;
-        ptr->o_size += num_bytes;
-
-        return p;
-    }
-
-    tmp = malloc(actual_bytes);
-    if(!tmp)
-    {
-        return 0;
-    }
-    memcpy(tmp, (void *)ptr->address, ptr->size);
-    prev->next = ptr->next;     /* delete the node which need be released from the memory block chain  */
-
-    return tmp;
+	struct alloc_head_t *head;
+	void   *tmp;
+
+	if(!p)
+	{
+		return malloc(num_bytes);
+	}
+	if (!num_bytes)
+	{
+		free(p);
+		return 0;
+	}
+
+	head = malloc_head(p);
+	if (!head)
+		return 0;
+	if (num_bytes <= head->size)
+		return p;
+
+	/* the last large block grows in place */
+	if (head->cls == MALLOC_CLASSES && (phys_addr_t)p + head->size == heap_cur) {
+		if (heap_end - (phys_addr_t)p < MY_BYTE_ALIGN(num_bytes))
+			return 0;
+		head->size = MY_BYTE_ALIGN(num_bytes);
+		heap_cur = (phys_addr_t)p + head->size;
+		return p;
+	}
+
+	tmp = malloc(num_bytes);
+	if(!tmp)
+	{
+		return 0;
+	}
+	memcpy(tmp, p, head->size);
+	free(p);
+
+	return tmp;
 }
 
 /*
@@ -186,38 +197,82 @@ void *realloc(void *p, __u32 num_bytes)
 *
 * Description: free buffer to heap
 *
-* Aguments   : p    the po__s32er to the buffer which need be free.
+* Aguments   : p    the pointer to the buffer which need be free.
 *
 * Returns    : none
 *********************************************************************************************************
 */
 void  free(void *p)
 {
-    struct alloc_struct_t *ptr, *prev;
+	struct alloc_head_t *head;
+	struct alloc_free_t *blk = p;
 
 	if( p == NULL )
 		return;
 
-    ptr = &boot_heap_head;                /* look for the node which po__s32 this memory block                     */
-    while (ptr && ptr->next)
-    {
-		if (ptr->next->address == (phys_addr_t)p)
-            break;              /* find the node which need to be release                              */
-        ptr = ptr->next;
-    }
-
-	prev = ptr;
-	ptr = ptr->next;
-
-    if (!ptr) return;           /* the node is heap boot_heap_tail                                               */
-
-    prev->next = ptr->next;     /* delete the node which need be released from the memory block chain  */
+	head = malloc_head(p);
+	if (!head)
+		return;
 
-    return ;
+	head->seq = 0;
+	if (head->cls < MALLOC_CLASSES) {
+		blk->next = heap_pool[head->cls];
+		heap_pool[head->cls] = blk;
+	} else if ((phys_addr_t)p + head->size == heap_cur) {
+		heap_cur = (phys_addr_t)head;
+	}
 }
 
+/*
+*********************************************************************************************************
+*                       MARK / RELEASE HEAP
+*
+* Description: malloc_mark() returns the number of the last allocation, malloc_release() frees
+*              everything allocated since that mark at once, pooled blocks included wherever they
+*              are in the arena. The arena is cut back past the last block still in use, the
+*              pooled blocks below it go back on their free lists. Large blocks freed below a
+*              block still in use stay lost until the arena is cut back past them. Wrap a decoder
+*              in them to run it again and again from the same memory.
+*
+* Aguments   : mark    a value malloc_mark() returned.
+*
+* Returns    : the mark / none
+*********************************************************************************************************
+*/
+ulong malloc_mark(void)
+{
+	return heap_seq;
+}
 
+void malloc_release(ulong mark)
+{
+	struct alloc_head_t *head;
+	struct alloc_free_t *blk;
+	phys_addr_t p, top = heap_start;
+	int i;
 
+	if (mark > heap_seq)
+		return;
 
-
-
+	/* free what came after the mark, find the end of what is left */
+	for (p = heap_start; p < heap_cur; p += sizeof(*head) + head->size) {
+		head = (struct alloc_head_t *)p;
+		if (head->seq > mark)
+			head->seq = 0;
+		if (head->seq)
+			top = p + sizeof(*head) + head->size;
+	}
+
+	/* and rebuild the pools from the free blocks below it */
+	for (i = 0; i < MALLOC_CLASSES; i++)
+		heap_pool[i] = NULL;
+	for (p = heap_start; p < top; p += sizeof(*head) + head->size) {
+		head = (struct alloc_head_t *)p;
+		if (!head->seq && head->cls < MALLOC_CLASSES) {
+			blk = (struct alloc_free_t *)(head + 1);
+			blk->next = heap_pool[head->cls];
+			heap_pool[head->cls] = blk;
+		}
+	}
+	heap_cur = top;
+}
@@ -339,17 +339,170 @@ abort:
 }
 
 
+#ifdef CFG_BOOT0_CONSOLE_RING
+/*
+ * printf() only appends to console_ring, which is fed to the UART as its
+ * TX FIFO has room. It blocks on the UART only when the ring is full.
+ * From console_log_init() on, everything printed is also kept in DRAM
+ * for the next stage.
+ */
+#define CONSOLE_RING_SIZE	4096	/* power of 2 */
+
+static char console_ring[CONSOLE_RING_SIZE];
+static u32 console_head, console_tail;	/* free running */
+static struct boot0_log *console_log;
+
+static void console_drain(void)
+{
+	while (console_tail != console_head &&
+	       !sunxi_serial_try_putc(console_ring[console_tail % CONSOLE_RING_SIZE]))
+		console_tail++;
+}
+
+static void console_putc(char ch)
+{
+	while (console_head - console_tail == CONSOLE_RING_SIZE)
+		console_drain();
+	console_ring[console_head++ % CONSOLE_RING_SIZE] = ch;
+	if (!console_log)
+		return;
+	if (console_log->len < console_log->size)
+		console_log->buf[console_log->len++] = ch;
+	else
+		console_log->dropped++;
+}
+
+/* before leaving boot0, or hanging */
+void console_flush(void)
+{
+	while (console_tail != console_head)
+		console_drain();
+	sunxi_serial_flush();
+}
+
+/* keep the log at base from now on, starting with what the ring still has */
+void console_log_init(void *base, u32 size)
+{
+	struct boot0_log *log = base;
+	u32 i = console_head > CONSOLE_RING_SIZE ? console_head - CONSOLE_RING_SIZE : 0;
+
+	log->magic = BOOT0_LOG_MAGIC;
+	log->size = size - sizeof(*log);
+	log->len = 0;
+	log->dropped = i;
+	for (; i != console_head; i++)
+		log->buf[log->len++] = console_ring[i % CONSOLE_RING_SIZE];
+	console_log = log;
+}
+#else
+#define console_putc(ch)	sunxi_serial_putc(ch)
+#define console_drain()		do { } while (0)
+#endif
+
+#ifdef CFG_BOOT0_BINLOG
+/*
+ * once blog_init() has run blog_printf(), which the log levels above
+ * CFG_LOG_LEVEL_UART go to, only records its format string and arguments,
+ * tools/boot0_blog.py does the formatting later on the host. Text is still
+ * printed as well in debug mode 8. printf() itself stays on the console.
+ */
+#define BLOG_STR_MAX		64
+
+static struct boot0_log *blog;
+
+void blog_init(void *base, u32 size)
+{
+	blog = base;
+	blog->magic = BOOT0_BLOG_MAGIC;
+	blog->size = size - sizeof(*blog);
+	blog->len = 0;
+	blog->dropped = 0;
+}
+
+/* take the arguments as _vprintf() does */
+static void blog_record(const char *fmt, va_list va)
+{
+	struct boot0_blog_rec *rec = (void *)(blog->buf + blog->len);
+	u8 *end = (u8 *)blog->buf + blog->size;
+	u64 *p = (u64 *)(rec + 1);
+	const char *f = fmt, *s;
+	bool islong;
+	u32 n;
+	char ch;
+
+	if ((u8 *)p > end)
+		goto full;
+	while ((ch = *f++)) {
+		if (ch != '%')
+			continue;
+		ch = *f++;
+		if (ch == '-')
+			ch = *f++;
+		if (ch == '0')
+			ch = *f++;
+		while (ch >= '0' && ch <= '9')
+			ch = *f++;
+		islong = ch == 'l';
+		if (islong)
+			ch = *f++;
+		if (ch == '\0')
+			break;
+		/* the conversions _vprintf() takes no argument for store none */
+		if (!strchr("udxcsp", ch))
+			continue;
+		if ((u8 *)(p + 1) > end)
+			goto full;
+		switch (ch) {
+		case 'u':
+		case 'd':
+		case 'x':
+			*p++ = islong ? va_arg(va, unsigned long) : va_arg(va, unsigned int);
+			break;
+		case 'c':
+			*p++ = va_arg(va, int);
+			break;
+		case 's':
+			s = va_arg(va, char *);
+			n = s ? strnlen(s, BLOG_STR_MAX) : 0;
+			if ((u8 *)(p + 1) + n > end)
+				goto full;
+			*p++ = n;
+			memcpy(p, s, n);
+			p += (n + 7) / 8;
+			break;
+		case 'p':
+			*p++ = (ulong)va_arg(va, void *);
+			while (isalnum(f[0]))
+				f++;
+			break;
+		}
+	}
+	rec->fmt = (ulong)fmt;
+	rec->size = (u8 *)p - (u8 *)rec;
+	rec->stamp = get_arch_counter();
+	blog->len += rec->size;
+	return;
+
+full:
+	blog->dropped++;
+}
+#endif
+
 static void putc_normal(struct printf_info *info, char ch)
 {
-	sunxi_serial_putc(ch);
+	console_putc(ch);
 }
 
 int vprintf(const char *fmt, va_list va)
 {
 	struct printf_info info;
+	int ret;
 
 	info.putc = putc_normal;
-	return _vprintf(&info, fmt, va);
+	ret = _vprintf(&info, fmt, va);
+	console_drain();
+
+	return ret;
 }
 
 static u8 debug_mode = 3;
@@ -370,11 +523,9 @@ u8 sunxi_get_printf_debug_mode(void)
 }
 
 int sprintf(char *buf, const char *fmt, ...);
-int printf(const char *fmt, ...)
+static int vprintf_stamped(const char *fmt, va_list va)
 {
 	struct printf_info info;
-
-	va_list va;
 	int ret;
 	char time_stamp[12];
 	int i;
@@ -391,16 +542,49 @@ int printf(const char *fmt, ...)
 	for (i = 0; i < sizeof(time_stamp); i++) {
 		if (time_stamp[i] == 0)
 			break;
-		sunxi_serial_putc(time_stamp[i]);
+		console_putc(time_stamp[i]);
 	}
 	info.putc = putc_normal;
-	va_start(va, fmt);
 	ret = _vprintf(&info, fmt, va);
+	console_drain();
+
+	return ret;
+}
+
+int printf(const char *fmt, ...)
+{
+	va_list va;
+	int ret;
+
+	va_start(va, fmt);
+	ret = vprintf_stamped(fmt, va);
 	va_end(va);
 
 	return ret;
 }
 
+#ifdef CFG_BOOT0_BINLOG
+/* printed as printf() would until blog_init(), and in debug mode 8 */
+int blog_printf(const char *fmt, ...)
+{
+	va_list va;
+	int ret = 0;
+
+	if (blog) {
+		va_start(va, fmt);
+		blog_record(fmt, va);
+		va_end(va);
+	}
+	if (!blog || debug_mode == 8) {
+		va_start(va, fmt);
+		ret = vprintf_stamped(fmt, va);
+		va_end(va);
+	}
+
+	return ret;
+}
+#endif
+
 void puts(const char *s)
 {
 	printf("%s", s);
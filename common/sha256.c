@@ -0,0 +1,132 @@
+/*
+ * SPDX-License-Identifier:	GPL-2.0+
+ *
+ * SHA-256 (FIPS 180-4), with the U-Boot sha256_starts/update/finish API so
+ * images can be hashed chunk by chunk as they are read.
+ */
+#include <common.h>
+#include <u-boot/sha256.h>
+
+static const uint32_t sha256_k[64] = {
+	0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1,
+	0x923F82A4, 0xAB1C5ED5, 0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3,
+	0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174, 0xE49B69C1, 0xEFBE4786,
+	0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+	0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147,
+	0x06CA6351, 0x14292967, 0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13,
+	0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85, 0xA2BFE8A1, 0xA81A664B,
+	0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+	0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A,
+	0x5B9CCA4F, 0x682E6FF3, 0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208,
+	0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2
+};
+
+#define ROR(x, n)	(((x) >> (n)) | ((x) << (32 - (n))))
+#define S0(x)		(ROR(x, 7) ^ ROR(x, 18) ^ ((x) >> 3))
+#define S1(x)		(ROR(x, 17) ^ ROR(x, 19) ^ ((x) >> 10))
+#define S2(x)		(ROR(x, 2) ^ ROR(x, 13) ^ ROR(x, 22))
+#define S3(x)		(ROR(x, 6) ^ ROR(x, 11) ^ ROR(x, 25))
+
+#define GET_UINT32_BE(b, i)	(((uint32_t)(b)[i] << 24) | ((uint32_t)(b)[(i) + 1] << 16) | \
+				 ((uint32_t)(b)[(i) + 2] << 8) | (uint32_t)(b)[(i) + 3])
+
+void sha256_starts(sha256_context *ctx)
+{
+	ctx->total[0] = 0;
+	ctx->total[1] = 0;
+
+	ctx->state[0] = 0x6A09E667;
+	ctx->state[1] = 0xBB67AE85;
+	ctx->state[2] = 0x3C6EF372;
+	ctx->state[3] = 0xA54FF53A;
+	ctx->state[4] = 0x510E527F;
+	ctx->state[5] = 0x9B05688C;
+	ctx->state[6] = 0x1F83D9AB;
+	ctx->state[7] = 0x5BE0CD19;
+}
+
+static void sha256_process(sha256_context *ctx, const uint8_t *data)
+{
+	uint32_t w[16], s[8], t1, t2;
+	int i;
+
+	for (i = 0; i < 8; i++)
+		s[i] = ctx->state[i];
+
+	/* w[] is a 16 word window over the message schedule */
+	for (i = 0; i < 64; i++) {
+		if (i < 16)
+			w[i] = GET_UINT32_BE(data, 4 * i);
+		else
+			w[i & 15] += S1(w[(i - 2) & 15]) + w[(i - 7) & 15] + S0(w[(i - 15) & 15]);
+
+		t1 = s[7] + S3(s[4]) + (s[6] ^ (s[4] & (s[5] ^ s[6]))) + sha256_k[i] + w[i & 15];
+		t2 = S2(s[0]) + ((s[0] & s[1]) | (s[2] & (s[0] | s[1])));
+		s[7] = s[6];
+		s[6] = s[5];
+		s[5] = s[4];
+		s[4] = s[3] + t1;
+		s[3] = s[2];
+		s[2] = s[1];
+		s[1] = s[0];
+		s[0] = t1 + t2;
+	}
+
+	for (i = 0; i < 8; i++)
+		ctx->state[i] += s[i];
+}
+
+void sha256_update(sha256_context *ctx, const uint8_t *input, uint32_t length)
+{
+	uint32_t left, fill;
+
+	if (!length)
+		return;
+
+	left = ctx->total[0] & 0x3F;
+	fill = 64 - left;
+
+	ctx->total[0] += length;
+	if (ctx->total[0] < length)
+		ctx->total[1]++;
+
+	if (left && length >= fill) {
+		memcpy(ctx->buffer + left, input, fill);
+		sha256_process(ctx, ctx->buffer);
+		length -= fill;
+		input += fill;
+		left = 0;
+	}
+
+	/* whole blocks straight from the input, no copy */
+	while (length >= 64) {
+		sha256_process(ctx, input);
+		length -= 64;
+		input += 64;
+	}
+
+	if (length)
+		memcpy(ctx->buffer + left, input, length);
+}
+
+void sha256_finish(sha256_context *ctx, uint8_t digest[SHA256_SUM_LEN])
+{
+	static const uint8_t padding[64] = { 0x80 };
+	uint32_t high, low, last;
+	uint8_t msglen[8];
+	int i;
+
+	high = (ctx->total[0] >> 29) | (ctx->total[1] << 3);
+	low  = ctx->total[0] << 3;
+	for (i = 0; i < 4; i++) {
+		msglen[i]     = high >> (24 - 8 * i);
+		msglen[i + 4] = low >> (24 - 8 * i);
+	}
+
+	last = ctx->total[0] & 0x3F;
+	sha256_update(ctx, padding, (last < 56) ? (56 - last) : (120 - last));
+	sha256_update(ctx, msglen, 8);
+
+	for (i = 0; i < 32; i++)
+		digest[i] = ctx->state[i / 4] >> (24 - 8 * (i % 4));
+}
@@ -147,7 +147,7 @@ size_t strspn(const char *s, const char *accept)
 	return count;
 }
 
-#ifndef CFG_SUNXI_MEMOP
+#if !defined(CFG_SUNXI_MEMOP) && !defined(CFG_ARCH_RISCV)
 extern void * memset0(void * s, int c, size_t count);
 
 void * memset(void * s, int c, size_t count)
@@ -0,0 +1,112 @@
+/*
+ * SPDX-License-Identifier:	GPL-2.0+
+ *
+ * DRAM to DRAM copies on a sunxi DMA channel, so the CPU can sum, hash or
+ * decompress one buffer while another is moved. One copy is in flight at a
+ * time: dma_memcpy() waits for the previous one before it starts, and
+ * dma_memcpy_wait() must be called before the destination is used or the
+ * next stage is entered. The source is cleaned out of the dcache before the
+ * start and the destination invalidated after the end; the CPU must not
+ * write to either, nor to the rest of the cache lines the destination
+ * shares, until then.
+ *
+ * dma_memcpy() returns -1 without copying for what the engine can't take
+ * (unaligned, no channel, out of list nodes) and the caller copies on the
+ * CPU. Copies over SUNXI_DMA_NODE_MAX run as a list of several nodes.
+ * With CFG_SUNXI_DMA_MEMCPY_TEST every copy is compared with its source once
+ * it is done, and redone with memcpy() if it differs.
+ */
+
+#include <common.h>
+#include <arch/dma.h>
+
+#define DMA_MEMCPY_TIMEOUT_US	1000000
+
+static ulong dma_memcpy_hd;
+static void *cur_dst;
+static const void *cur_src;
+static u32 cur_len;
+
+static int dma_memcpy_channel(void)
+{
+	sunxi_dma_set cfg;
+
+	sunxi_dma_init();
+	dma_memcpy_hd = sunxi_dma_request_from_last(DMAC_DMATYPE_NORMAL);
+	if (!dma_memcpy_hd) {
+		pr_warn("dma_memcpy: no channel\n");
+		return -1;
+	}
+
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.channal_cfg.src_drq_type	 = DMAC_CFG_TYPE_DRAM;
+	cfg.channal_cfg.src_addr_mode	 = DMAC_CFG_SRC_ADDR_TYPE_LINEAR_MODE;
+	cfg.channal_cfg.src_burst_length = DMAC_CFG_SRC_8_BURST;
+	cfg.channal_cfg.src_data_width	 = DMAC_CFG_SRC_DATA_WIDTH_32BIT;
+	cfg.channal_cfg.dst_drq_type	 = DMAC_CFG_TYPE_DRAM;
+	cfg.channal_cfg.dst_addr_mode	 = DMAC_CFG_DEST_ADDR_TYPE_LINEAR_MODE;
+	cfg.channal_cfg.dst_burst_length = DMAC_CFG_DEST_8_BURST;
+	cfg.channal_cfg.dst_data_width	 = DMAC_CFG_DEST_DATA_WIDTH_32BIT;
+
+	return sunxi_dma_setting(dma_memcpy_hd, &cfg);
+}
+
+void dma_memcpy_wait(void)
+{
+	ulong start = timer_get_us();
+	int done;
+
+	if (!cur_len)
+		return;
+
+	while (!(done = sunxi_dma_list_done(dma_memcpy_hd, -1))) {
+		if (timer_get_us() - start > DMA_MEMCPY_TIMEOUT_US)
+			break;
+	}
+	if (done <= 0) {
+		/* stuck, or the channel was freed by sunxi_dma_exit() */
+		pr_err("dma_memcpy: %x bytes to %p failed\n", cur_len, cur_dst);
+		sunxi_dma_stop(dma_memcpy_hd);
+		memcpy(cur_dst, cur_src, cur_len);
+		cur_len = 0;
+		return;
+	}
+	sunxi_dma_list_free(dma_memcpy_hd);
+	invalidate_dcache_range((ulong)cur_dst, (ulong)cur_dst + cur_len);
+
+#ifdef CFG_SUNXI_DMA_MEMCPY_TEST
+	if (memcmp(cur_dst, cur_src, cur_len)) {
+		pr_err("dma_memcpy: %x bytes %p to %p differ from memcpy\n",
+		       cur_len, cur_src, cur_dst);
+		memcpy(cur_dst, cur_src, cur_len);
+	} else {
+		pr_info("dma_memcpy: %x bytes %p to %p ok\n", cur_len, cur_src, cur_dst);
+	}
+#endif
+	cur_len = 0;
+}
+
+int dma_memcpy(void *dst, const void *src, u32 len)
+{
+	if (!len || (((ulong)dst | (ulong)src | len) & 3))
+		return -1;
+
+	dma_memcpy_wait();
+	if (!dma_memcpy_hd && dma_memcpy_channel())
+		return -1;
+
+	if (sunxi_dma_list_add(dma_memcpy_hd, (ulong)src, (ulong)dst, len, NULL) < 0) {
+		/* freed under us by sunxi_dma_exit()? */
+		if (sunxi_dma_querystatus(dma_memcpy_hd) < 0)
+			dma_memcpy_hd = 0;
+		return -1;
+	}
+	flush_dcache_range((ulong)src, (ulong)src + len);
+	flush_dcache_range((ulong)dst, (ulong)dst + len);
+	sunxi_dma_list_start(dma_memcpy_hd);
+	cur_dst = dst;
+	cur_src = src;
+	cur_len = len;
+
+	return 0;
+}
@@ -4,6 +4,9 @@
 #include <arch/dram_v2.h>
 
 #include "sdram.h"
+#ifdef CFG_RISCV_VECTOR
+#include <asm/vector.h>
+#endif
 
 #undef readl
 #undef writel
@@ -900,7 +903,7 @@ void mctl_phy_ac_remapping(dram_para_t *para)
 
 	// read SID info @ 0x228
 	fuse = (readl(0x3002228) >> 8) & 0x4;
-	printf("ddr_efuse_type: 0x%x\n", fuse);
+	pr_debug("ddr_efuse_type: 0x%x\n", fuse);
 
 	if ((para->dram_tpr13 >> 18) & 0x3) {
 		memcpy_self(cfg0, cfg7, 22);
@@ -1147,7 +1150,7 @@ unsigned int mctl_channel_init(unsigned int ch_index, dram_para_t *para)
 	// Check for training error
 	val = readl(0x3103010);
 	if (((val >> 20) & 0xff) && (val & 0x100000)) {
-		printf("ZQ calibration error, check external 240 ohm resistor.\n");
+		pr_err("ZQ calibration error, check external 240 ohm resistor.\n");
 		return 0;
 	}
 
@@ -1243,11 +1246,11 @@ int dqs_gate_detect(dram_para_t *para)
 			if (dx0 != dx1) {
 				rval |= 0x1;
 				para->dram_para2 = rval;
-				printf("[AUTO DEBUG] single rank and half DQ!\n");
+				pr_debug("[AUTO DEBUG] single rank and half DQ!\n");
 				return 1;
 			}
 			para->dram_para2 = rval;
-			printf("[AUTO DEBUG] single rank and full DQ!\n");
+			pr_debug("[AUTO DEBUG] single rank and full DQ!\n");
 			return 1;
 		}
 		else if (dx0 == 0) {
@@ -1255,13 +1258,13 @@ int dqs_gate_detect(dram_para_t *para)
 			rval &= 0xfffffff0;
 			rval |= 0x00001001;
 			para->dram_para2 = rval;
-			printf("[AUTO DEBUG] dual rank and half DQ!\n");
+			pr_debug("[AUTO DEBUG] dual rank and half DQ!\n");
 			return 1;
 		}
 		else {
 			if (para->dram_tpr13 & (1 << 29)) {
-				printf("DX0 state:%d\n", dx0);
-				printf("DX1 state:%d\n", dx1);
+				pr_debug("DX0 state:%d\n", dx0);
+				pr_debug("DX1 state:%d\n", dx1);
 			}
 			return 0;
 		}
@@ -1271,7 +1274,7 @@ int dqs_gate_detect(dram_para_t *para)
 		rval &= 0xfffffff0;
 		rval |= 0x00001000;
 		para->dram_para2 = rval;
-		printf("[AUTO DEBUG] two rank and full DQ!\n");
+		pr_debug("[AUTO DEBUG] two rank and full DQ!\n");
 		return 1;
 	}
 }
@@ -1287,30 +1290,46 @@ int dramc_simple_wr_test(uint mem_mb, int len)
 	unsigned int  patt2 = 0xfedcba98;
 	unsigned int *addr, v1, v2, i;
 
+#ifdef CFG_RISCV_VECTOR
+	/* the scalar loops below only run again to report a mismatch */
+	if (vec_dram_fill) {
+		vec_dram_fill(SDRAM_BASE, patt1, len);
+		vec_dram_fill(SDRAM_BASE + offs, patt2, len);
+		if (!vec_dram_check(SDRAM_BASE, patt1, len) &&
+		    !vec_dram_check(SDRAM_BASE + offs, patt2, len)) {
+			pr_info("DRAM simple test OK.\n");
+			return 0;
+		}
+		goto check;
+	}
+#endif
 	addr = SDRAM_BASE;
 	for (i = 0; i != len; i++, addr++) {
 		writel(addr,        patt1 + i);
 		writel(addr + offs, patt2 + i);
 	}
 
+#ifdef CFG_RISCV_VECTOR
+check:
+#endif
 	addr = SDRAM_BASE;
 	for (i = 0; i != len; i++) {
 		v1 = readl(addr+i);
 		v2 = patt1 + i;
 		if (v1 != v2) {
-			printf("DRAM simple test FAIL.\n");
-			printf("%x != %x at address %x\n", v1, v2, addr+i);
+			pr_err("DRAM simple test FAIL.\n");
+			pr_err("%x != %x at address %x\n", v1, v2, addr+i);
 			return 1;
 		}
 		v1 = readl(addr+offs+i);
 		v2 = patt2 + i;
 		if (v1 != v2) {
-			printf("DRAM simple test FAIL.\n");
-			printf("%x != %x at address %x\n", v1, v2, addr+offs+i);
+			pr_err("DRAM simple test FAIL.\n");
+			pr_err("%x != %x at address %x\n", v1, v2, addr+offs+i);
 			return 1;
 		}
 	}
-	printf("DRAM simple test OK.\n");
+	pr_info("DRAM simple test OK.\n");
 	return 0;
 }
 
@@ -1365,7 +1384,7 @@ int auto_scan_dram_size(dram_para_t *para) // s7
 	unsigned int	chk, ptr, shft, banks;
 
 	if (mctl_core_init(para) == 0) {
-		printf("[ERROR DEBUG] DRAM initialisation error : 0!\n");
+		pr_err("[ERROR DEBUG] DRAM initialisation error : 0!\n");
 		return 0;
 	}
 
@@ -1401,7 +1420,7 @@ int auto_scan_dram_size(dram_para_t *para) // s7
 		out1: ;
 		}
 		if (i > 16) i = 16;
-		printf("[AUTO DEBUG] rank %d row = %d\n", rank, i);
+		pr_debug("[AUTO DEBUG] rank %d row = %d\n", rank, i);
 
 		// Store rows in para 1
 		shft = 4 + offs;
@@ -1437,7 +1456,7 @@ int auto_scan_dram_size(dram_para_t *para) // s7
 			chk += 4;
 		}
 		banks = (j + 1) << 2; // 4 or 8
-		printf("[AUTO DEBUG] rank %d bank = %d\n", rank, banks);
+		pr_debug("[AUTO DEBUG] rank %d bank = %d\n", rank, banks);
 
 		// Store banks in para 1
 		shft = 12 + offs;
@@ -1476,7 +1495,7 @@ int auto_scan_dram_size(dram_para_t *para) // s7
 		}
 		if (i > 13) i = 13;
 		int pgsize = (i==9) ? 0 : (1 << (i-10));
-		printf("[AUTO DEBUG] rank %d page size = %d KB\n", rank, pgsize);
+		pr_debug("[AUTO DEBUG] rank %d page size = %d KB\n", rank, pgsize);
 
 		// Store page size
 		shft = offs;
@@ -1507,11 +1526,11 @@ int auto_scan_dram_size(dram_para_t *para) // s7
 		para->dram_para2 &= 0xfffff0ff;
 		// note: rval is equal to para->dram_para1 here
 		if ((rval & 0xffff) == ((rval >> 16) & 0xffff)) {
-			printf("rank1 config same as rank0\n");
+			pr_debug("rank1 config same as rank0\n");
 		}
 		else {
 			para->dram_para2 |= 0x00000100;
-			printf("rank1 config different from rank0\n");
+			pr_debug("rank1 config different from rank0\n");
 		}
 	}
 	return 1;
@@ -1558,13 +1577,13 @@ int auto_scan_dram_config(dram_para_t *para)
 	if (((para->dram_tpr13 & (1 << 14)) == 0) &&
 	    (auto_scan_dram_rank_width(para) == 0))
 	{
-		printf("[ERROR DEBUG] auto scan dram rank & width failed !\n");
+		pr_err("[ERROR DEBUG] auto scan dram rank & width failed !\n");
 		return 0;
 	}
 	if (((para->dram_tpr13 & (1 << 0)) == 0)  &&
 	    (auto_scan_dram_size(para) == 0 ))
 	{
-		printf("[ERROR DEBUG] auto scan dram size failed !\n");
+		pr_err("[ERROR DEBUG] auto scan dram size failed !\n");
 		return 0;
 	}
 	if ((para->dram_tpr13 & (1 << 15)) == 0) {
@@ -1580,7 +1599,7 @@ signed int init_DRAM(int type, dram_para_t *para) // s0
 
 	// Test ZQ status
 	if (para->dram_tpr13 & (1 << 16)) {
-		printf("DRAM only have internal ZQ!!\n");
+		pr_debug("DRAM only have internal ZQ!!\n");
 		writel(0x3000160, readl(0x3000160) |  0x100);
 		writel(0x3000168, 0);
 		sdelay(10);
@@ -1593,12 +1612,12 @@ signed int init_DRAM(int type, dram_para_t *para) // s0
 		sdelay(10);
 		writel(0x3000160, readl(0x3000160) |  0x001);
 		sdelay(20);
-		printf("ZQ value = 0x%x***********\n", readl(0x3000172));
+		pr_debug("ZQ value = 0x%x***********\n", readl(0x3000172));
 	}
 
 	// Set voltage
 	rc = get_pmu_exists();
-	printf("get_pmu_exist() = %d\n", rc);
+	pr_debug("get_pmu_exist() = %d\n", rc);
 	if ( rc<0 ) {
 		dram_vol_set(para);
 	}
@@ -1615,28 +1634,28 @@ signed int init_DRAM(int type, dram_para_t *para) // s0
 	}
 
 	// Print header message (too late)
-	printf("DRAM BOOT DRIVE INFO: %s\n", "V0.24");
-	printf("DRAM CLK = %d MHz\n", para->dram_clk);
-	printf("DRAM Type = %d (2:DDR2,3:DDR3)\n", para->dram_type);
+	pr_info("DRAM BOOT DRIVE INFO: %s\n", "V0.24");
+	pr_info("DRAM CLK = %d MHz\n", para->dram_clk);
+	pr_info("DRAM Type = %d (2:DDR2,3:DDR3)\n", para->dram_type);
 	if ( (para->dram_odt_en & 0x1) == 0 ) {
-		printf("DRAMC read ODT  off.\n");
+		pr_debug("DRAMC read ODT  off.\n");
 	}
 	else {
-		printf("DRAMC ZQ value: 0x%x\n", para->dram_zq);
+		pr_debug("DRAMC ZQ value: 0x%x\n", para->dram_zq);
 	}
 
 	// report ODT
 	rc = para->dram_mr1;
 	if ( (rc & 0x44)==0 ) {
-		printf("DRAM ODT off.\n");
+		pr_debug("DRAM ODT off.\n");
 	}
 	else {
-		printf("DRAM ODT value: 0x%x.\n", rc);
+		pr_debug("DRAM ODT value: 0x%x.\n", rc);
 	}
 
 	// Init core, final run
 	if ( mctl_core_init(para)==0 ) {
-		printf("DRAM initialisation error : 1 !\n");
+		pr_err("DRAM initialisation error : 1 !\n");
 		return 0;
 	}
 
@@ -1647,7 +1666,7 @@ signed int init_DRAM(int type, dram_para_t *para) // s0
 	}
 	else {
 		rc = DRAMC_get_dram_size();
-		printf("DRAM SIZE =%d M\n", rc);
+		pr_info("DRAM SIZE =%d M\n", rc);
 		para->dram_para2 = (para->dram_para2 & 0xffffu) | rc << 16;
 	}
 	mem_size = rc;
@@ -1661,7 +1680,7 @@ signed int init_DRAM(int type, dram_para_t *para) // s0
 		writel(0x31030a0, rc);
 		writel(0x310309c, 0x40a);
 		writel(0x3103004, readl(0x3103004) | 1 );
-		printf("Enable Auto SR");
+		pr_debug("Enable Auto SR");
 	}
 	else {
 		writel(0x31030a0, readl(0x31030a0) & 0xffff0000);
@@ -89,7 +89,7 @@ int sunxi_dram_handle(void)
 			select_dram_para += (io_en * 8);
 			if (select_dram_para != 0) {
 				if (select_para->dram_para[select_dram_para-1][0] == 0) {
-					printf("dram para%d invalid use default para\n", select_dram_para);
+					pr_warn("dram para%d invalid use default para\n", select_dram_para);
 					select_dram_para = 0;
 				} else {
 					memcpy(dram_para, select_para->dram_para[select_dram_para-1], sizeof(select_para->dram_para[0]));
@@ -102,7 +102,7 @@ int sunxi_dram_handle(void)
 				}
 				vaild_para++;
 			}
-			printf("vaild para:%d  select dram para%d\n", vaild_para,  select_dram_para);
+			pr_info("vaild para:%d  select dram para%d\n", vaild_para,  select_dram_para);
 #ifdef AUTO_DRAM_DEBUG
 			while (1) {
 				char uart_val = get_uart_input();
@@ -125,11 +125,11 @@ int sunxi_dram_handle(void)
 			}
 #endif
 		} else {
-			printf("extd_head bad magic\n");
+			pr_err("extd_head bad magic\n");
 			return -1;
 		}
 	} else {
-		printf("dram return write ok\n");
+		pr_debug("dram return write ok\n");
 	}
 
 	if (sunxi_get_printf_debug_mode() >= 4) {
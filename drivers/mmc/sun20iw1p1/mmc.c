@@ -22,6 +22,9 @@
 #define CONFIG_SYS_MMC_MAX_BLK_COUNT 65535
 #endif
 
+/* mmc_bread() reports its throughput for reads of at least this many blocks */
+#define MMC_RATE_REPORT_BLKS 2048
+
 unsigned char mmc_arg_addr[SUNXI_SDMMC_PARAMETER_REGION_SIZE_BYTE];
 extern int mmc_config_addr; /*extern const boot0_file_head_t BT0_head; */
 static struct mmc *mmc_devices[MAX_MMC_NUM];
@@ -147,6 +150,7 @@ unsigned long mmc_bread(int dev_num, unsigned long start, unsigned blkcnt,
 			void *dst)
 {
 	unsigned cur, blocks_todo = blkcnt;
+	u32 t0;
 	struct mmc *mmc = find_mmc_device(dev_num);
 
 	if (blkcnt == 0) {
@@ -165,11 +169,17 @@ unsigned long mmc_bread(int dev_num, unsigned long start, unsigned blkcnt,
 		return 0;
 	}
 
+	if (mmc->async_blkcnt) {
+		mmcinfo("mmc %u async read pending\n", mmc->control_num);
+		return 0;
+	}
+
 	if (mmc_set_blocklen(mmc, mmc->read_bl_len)) {
 		mmcinfo("mmc %u Set block len failed\n", mmc->control_num);
 		return 0;
 	}
 
+	t0 = timer_get_us();
 	do {
 		cur = (blocks_todo > mmc->b_max) ? mmc->b_max : blocks_todo;
 		if (mmc_read_blocks(mmc, dst, start, cur) != cur) {
@@ -182,9 +192,117 @@ unsigned long mmc_bread(int dev_num, unsigned long start, unsigned blkcnt,
 		dst = (char *)dst + cur * mmc->read_bl_len;
 	} while (blocks_todo > 0);
 
+	t0 = timer_get_us() - t0;
+	if (blkcnt >= MMC_RATE_REPORT_BLKS && t0) {
+		/* bytes per us is MB/s */
+		u32 rate = (u32)((u64)blkcnt * mmc->read_bl_len * 10 / t0);
+		mmcinfo("mmc %u read %u KB in %u us, %u.%u MB/s\n", mmc->control_num,
+			(unsigned int)(blkcnt * mmc->read_bl_len >> 10), t0,
+			rate / 10, rate % 10);
+	}
+
 	return blkcnt;
 }
 
+/*
+ * start reading at most b_max blocks into dst, and return as soon as the card
+ * has accepted the command, while IDMAC moves the data; nothing else may be
+ * sent to the card until mmc_wait(). Small or unaligned reads go through PIO
+ * and are complete on return.
+ * returns the number of blocks being read (the caller issues the rest later),
+ * 0 on error
+ */
+unsigned long mmc_bread_async(int dev_num, unsigned long start, unsigned blkcnt,
+			      void *dst)
+{
+	struct mmc *mmc = find_mmc_device(dev_num);
+	struct mmc_cmd *cmd;
+	struct mmc_data *data;
+
+	if (!mmc) {
+		mmcinfo("Can not find mmc dev %d\n", dev_num);
+		return 0;
+	}
+	if (mmc->async_blkcnt) {
+		mmcinfo("mmc %u async read pending\n", mmc->control_num);
+		return 0;
+	}
+	if (blkcnt == 0 || (start + blkcnt) > mmc->lba) {
+		mmcinfo("mmc %u: bad async read 0x%x+%u\n", mmc->control_num,
+			(unsigned int)start, blkcnt);
+		return 0;
+	}
+	if (blkcnt > mmc->b_max)
+		blkcnt = mmc->b_max;
+
+	if (mmc_set_blocklen(mmc, mmc->read_bl_len)) {
+		mmcinfo("mmc %u Set block len failed\n", mmc->control_num);
+		return 0;
+	}
+
+	cmd  = &mmc->async_cmd;
+	data = &mmc->async_data;
+	if (blkcnt > 1)
+		cmd->cmdidx = MMC_CMD_READ_MULTIPLE_BLOCK;
+	else
+		cmd->cmdidx = MMC_CMD_READ_SINGLE_BLOCK;
+	if (mmc->high_capacity)
+		cmd->cmdarg = start;
+	else
+		cmd->cmdarg = start * mmc->read_bl_len;
+	cmd->resp_type = MMC_RSP_R1;
+	cmd->flags     = 0;
+
+	data->b.dest    = dst;
+	data->blocks    = blkcnt;
+	data->blocksize = mmc->read_bl_len;
+	data->flags     = MMC_DATA_READ;
+
+	if (mmc->send_cmd_start(mmc, cmd, data)) {
+		mmcinfo("mmc %u async read failed\n", mmc->control_num);
+		return 0;
+	}
+	mmc->async_blkcnt = blkcnt;
+
+	return blkcnt;
+}
+
+/*
+ * wait for the read started by mmc_bread_async() to land in memory
+ * returns its number of blocks, 0 on error or if there was none
+ */
+unsigned long mmc_wait(int dev_num)
+{
+	struct mmc *mmc = find_mmc_device(dev_num);
+	unsigned blkcnt;
+
+	if (!mmc || !mmc->async_blkcnt)
+		return 0;
+
+	blkcnt = mmc->async_blkcnt;
+	mmc->async_blkcnt = 0;
+	if (mmc->send_cmd_wait(mmc, &mmc->async_cmd, &mmc->async_data)) {
+		mmcinfo("mmc %u async read failed\n", mmc->control_num);
+		return 0;
+	}
+	/* the host sent the auto stop, wait for the card like mmc_read_blocks() */
+	if (blkcnt > 1 && mmc_send_status(mmc, 1000))
+		return 0;
+
+	return blkcnt;
+}
+
+/* largest number of blocks a single mmc_bread() issues as one CMD18 */
+unsigned mmc_bread_max(int dev_num)
+{
+	struct mmc *mmc = find_mmc_device(dev_num);
+
+	if (!mmc)
+		return 0;
+
+	return mmc->b_max;
+}
+
 int mmc_go_idle(struct mmc *mmc)
 {
 	struct mmc_cmd cmd;
@@ -394,6 +512,14 @@ int mmc_update_phase(struct mmc *mmc)
 	return mmc->update_phase(mmc);
 }
 
+int mmc_execute_tuning(struct mmc *mmc)
+{
+	if (mmc->execute_tuning == NULL)
+		return 0;
+
+	return mmc->execute_tuning(mmc);
+}
+
 int mmc_switch(struct mmc *mmc, u8 set, u8 index, u8 value)
 {
 	struct mmc_cmd cmd;
@@ -690,13 +816,13 @@ static void dumphex32(char *name, char *base, int len)
 {
 	__u32 i;
 
-	printf("dump %s registers:", name);
+	pr_debug("dump %s registers:", name);
 	for (i = 0; i < len; i += 4) {
 		if (!(i & 0xf))
-			printf("\n0x%x : ", base + i);
-		printf("%x ", *(unsigned int *)(base + i));
+			pr_debug("\n0x%x : ", base + i);
+		pr_debug("%x ", *(unsigned int *)(base + i));
 	}
-	printf("\n");
+	pr_debug("\n");
 }
 
 
@@ -715,7 +841,7 @@ int mmc_read_info(struct mmc *mmc, void *buffer, unsigned short length)
 retry:
 	ret = mmc_read_blocks(mmc, buffer, SUNXI_SDMMC_PARAMETER_REGION_LBA_START, length);
 	if (ret < 0) {
-		printf("%s %d:read region parameter fail, %s \n", __func__, __LINE__,
+		pr_err("%s %d:read region parameter fail, %s \n", __func__, __LINE__,
 					(retry_read < 3) ? "retry more time" : "go err");
 		dumphex32("info", buffer, 16);
 		if (retry_read < 3) {
@@ -736,7 +862,7 @@ retry:
 		}
 
 		if (sum != add_sum) {
-			printf("%s %d:region add sum(%x) is not right(%x), %s \n",
+			pr_err("%s %d:region add sum(%x) is not right(%x), %s \n",
 					__func__, __LINE__, sum, add_sum,
 					(retry_read < 3) ? "retry more time" : "go err");
 			if (retry_read < 3) {
@@ -746,7 +872,7 @@ retry:
 				goto err;
 		}
 	} else {
-		printf("%s %d:region magic is not right, %s %x\n", __func__, __LINE__,
+		pr_err("%s %d:region magic is not right, %s %x\n", __func__, __LINE__,
 				(retry_read < 3) ? "retry more time" : "go err", pregion->header.magic);
 		if (retry_read < 3) {
 			retry_read++;
@@ -1125,6 +1251,13 @@ int mmc_startup(struct mmc *mmc)
 	mmcdbg("%s: set clock %u\n", __FUNCTION__, mmc->tran_speed);
 	mmc_set_clock(mmc, mmc->tran_speed);
 
+	/* above 25MHz the sample delay must be tuned, stay at 25MHz if it can't */
+	if ((mmc->clock > 25000000) && mmc_execute_tuning(mmc)) {
+		mmcinfo("mmc %u tuning failed, fall back to 25MHz\n",
+			mmc->control_num);
+		mmc_set_clock(mmc, 25000000);
+	}
+
 	/* fill in device description */
 	mmc->blksz = mmc->read_bl_len;
 	/*mmc->lba = mmc->capacity/mmc->read_bl_len;*/   /*for compiler error */
@@ -401,11 +401,22 @@ struct mmc {
 	unsigned long long capacity;
 	int (*send_cmd) (struct mmc *mmc,
 			 struct mmc_cmd *cmd, struct mmc_data *data);
+	/* send_cmd split in two, the data transfer runs in between */
+	int (*send_cmd_start) (struct mmc *mmc,
+			 struct mmc_cmd *cmd, struct mmc_data *data);
+	int (*send_cmd_wait) (struct mmc *mmc,
+			 struct mmc_cmd *cmd, struct mmc_data *data);
 	void (*set_ios) (struct mmc *mmc);
 	int (*init) (struct mmc *mmc);
 	int (*update_phase) (struct mmc *mmc);
+	/* find a sample delay for the current clock, 0 if the card is usable */
+	int (*execute_tuning) (struct mmc *mmc);
 	struct tune_sdly tune_sdly;
 	unsigned b_max;
+	/* read started by mmc_bread_async(), async_blkcnt is 0 if none */
+	struct mmc_cmd async_cmd;
+	struct mmc_data async_data;
+	unsigned async_blkcnt;
 	unsigned lba;/* number of blocks */
 	unsigned blksz;/* block size */
 	char revision[8 + 8];/*char revision[8+1];*/        /* CID:  PRV */
@@ -13,6 +13,7 @@
  * Date: 2012-2-3 14:18:18
  */
 #include "common.h"
+#include <pmu.h>
 #include "mmc_def.h"
 #include "mmc_bsp.h"
 #include "mmc.h"
@@ -128,24 +129,26 @@ void set_mmc_para(int smc_no, void *addr, phys_addr_t uboot_base)
 	struct spare_boot_head_t *uboot_buf =
 		(struct spare_boot_head_t *)sunxi_get_iobase(uboot_base);
 
-	/*
-	 *memcpy((void *)(uboot_buf->boot_data.sdcard_spare_data),
-	 *       (addr + SDMMC_PRIV_INFO_ADDR_OFFSET),
-	 *       sizeof(struct boot_sdmmc_private_info_t));
-	 */
+	struct boot_sdmmc_private_info_t *priv_info =
+		(struct boot_sdmmc_private_info_t *)((char *)addr +
+						     SDMMC_PRIV_INFO_ADDR_OFFSET);
 
-	if (((struct sunxi_sdmmc_parameter_region *)mmc_arg_addr)->header.magic !=
+	if (((struct sunxi_sdmmc_parameter_region *)mmc_arg_addr)->header.magic ==
 			SDMMC_PARAMETER_MAGIC) {
-		printf("mmc not para\n");
+		memcpy((void *)(uboot_buf->boot_data.sdcard_spare_data),
+		       &(((struct sunxi_sdmmc_parameter_region *)mmc_arg_addr)->info),
+		       sizeof(struct boot_sdmmc_private_info_t));
+	} else if ((priv_info->ext_para0 & 0xFF000000) == EXT_PARA0_ID) {
+		/* no parameter region, pass on what boot0 tuned */
+		memcpy((void *)(uboot_buf->boot_data.sdcard_spare_data),
+		       priv_info, sizeof(struct boot_sdmmc_private_info_t));
+	} else {
+		pr_warn("mmc not para\n");
 		return;
 	}
 
-	memcpy((void *)(uboot_buf->boot_data.sdcard_spare_data),
-	       &(((struct sunxi_sdmmc_parameter_region *)mmc_arg_addr)->info),
-	       sizeof(struct boot_sdmmc_private_info_t));
-
 #ifndef SUNXI_MMCDBG
-	printf("tunning data addr:0x%x\n",
+	pr_info("tunning data addr:0x%x\n",
 		(uint)(ulong)(uboot_buf->boot_data.sdcard_spare_data));
 #else
 	u32 *p = NULL;
@@ -453,19 +456,44 @@ out:
 	return ret;
 }
 
+/* sample delay of a speed mode and frequency point in struct tune_sdly */
+static u8 mmc_get_tune_sdly(struct tune_sdly *tune_sdly, u32 spd_md_id,
+			    u32 freq_id)
+{
+	u32 shift = (freq_id % 4) * 8;
+
+	return (tune_sdly->tm4_smx_fx[spd_md_id * 2 + freq_id / 4] >> shift) &
+	       0xff;
+}
+
+static void mmc_set_tune_sdly(struct tune_sdly *tune_sdly, u32 spd_md_id,
+			      u32 freq_id, u8 dly)
+{
+	u32 *p	  = &tune_sdly->tm4_smx_fx[spd_md_id * 2 + freq_id / 4];
+	u32 shift = (freq_id % 4) * 8;
+
+	*p = (*p & ~(0xffU << shift)) | ((u32)dly << shift);
+}
+
 static int mmc_get_timing_cfg(u32 sdc_no, u32 spd_md_id, u32 freq_id, u8 *odly,
 			      u8 *sdly)
 {
 	s32 ret = 0;
 	u32 tm  = mmc_host[sdc_no].timing_mode;
+	struct boot_sdmmc_private_info_t *priv_info =
+		&((struct sunxi_sdmmc_parameter_region *)mmc_arg_addr)->info;
+	u8 dly;
 
 	if ((sdc_no == 2) && (tm == SUNXI_MMC_TIMING_MODE_4))
 		return mmc_get_timing_cfg_tm4(sdc_no, spd_md_id, freq_id, odly,
 					      sdly);
 	else if ((sdc_no == 0) && (tm == SUNXI_MMC_TIMING_MODE_1)) {
 		if ((spd_md_id <= HSSDR52_SDR25) && (freq_id <= CLK_50M)) {
+			/* sample phase 0~3, left at 0 unless tuned */
+			dly = mmc_get_tune_sdly(&priv_info->tune_sdly,
+						spd_md_id, freq_id);
 			*odly = 0;
-			*sdly = 0;
+			*sdly = (dly > 3) ? 0 : dly;
 			ret   = 0;
 		} else {
 			mmcinfo("sdc0 spd mode error, %d\n", spd_md_id);
@@ -570,8 +598,11 @@ static unsigned mmc_config_delay(struct sunxi_mmc_host *mmchost, u32 spd_md_id,
 	u8 odly, sdly, dsdly = 0;
 
 	if (mode == SUNXI_MMC_TIMING_MODE_1) {
-		odly = 0;
-		sdly = 0;
+		if (mmc_get_timing_cfg(mmchost->mmc_no, spd_md_id, freq_id,
+				       &odly, &sdly)) {
+			odly = 0;
+			sdly = 0;
+		}
 
 		mmcdbg("%s: odly: %d   sldy: %d\n", __FUNCTION__, odly, sdly);
 		rval = readl(&mmchost->reg->drv_dl);
@@ -672,14 +703,31 @@ OUT:
 	return ret;
 }
 
+/* frequency point of a card clock */
+static u32 mmc_freq_id(unsigned clk)
+{
+	if (clk <= 400000)
+		return CLK_400K;
+	else if (clk <= 26000000)
+		return CLK_25M;
+	else if (clk <= 52000000)
+		return CLK_50M;
+	else if (clk <= 100000000)
+		return CLK_100M;
+	else if (clk <= 150000000)
+		return CLK_150M;
+	else if (clk <= 200000000)
+		return CLK_200M;
+	else
+		return CLK_25M;
+}
+
 static int mmc_config_clock_modex(struct sunxi_mmc_host *mmchost, unsigned clk)
 {
 	unsigned rval   = 0;
 	struct mmc *mmc = mmchost->mmc;
 	unsigned mode   = mmchost->timing_mode;
 
-	unsigned freq;
-
 	/* disable mclk */
 	writel(0x0, IOMEM_ADDR(mmchost->mclkbase));
 	mmcdbg("mmc %d mclkbase 0x%x\n", mmchost->mmc_no,
@@ -756,22 +804,7 @@ static int mmc_config_clock_modex(struct sunxi_mmc_host *mmchost, unsigned clk)
 		return -1;
 
 	/* configure delay for current frequency and speed mode */
-	if (clk <= 400000)
-		freq = CLK_400K;
-	else if (clk <= 26000000)
-		freq = CLK_25M;
-	else if (clk <= 52000000)
-		freq = CLK_50M;
-	else if (clk <= 100000000)
-		freq = CLK_100M;
-	else if (clk <= 150000000)
-		freq = CLK_150M;
-	else if (clk <= 200000000)
-		freq = CLK_200M;
-	else
-		freq = CLK_25M;
-
-	mmc_config_delay(mmchost, mmc->speed_mode, freq);
+	mmc_config_delay(mmchost, mmc->speed_mode, mmc_freq_id(clk));
 
 	/*dumphex32("ccmu", (char*)SUNXI_CCM_BASE, 0x100); */
 	/*dumphex32("gpio", (char*)SUNXI_PIO_BASE, 0x100); */
@@ -1066,45 +1099,55 @@ static int mmc_core_init(struct mmc *mmc)
 	return 0;
 }
 
+/*
+ * PIO, used for small or not 4 byte aligned transfers. The timer is only
+ * read while waiting on the FIFO, not once per word.
+ */
 static int mmc_trans_data_by_cpu(struct mmc *mmc, struct mmc_data *data)
 {
 	struct sunxi_mmc_host *mmchost = (struct sunxi_mmc_host *)mmc->priv;
 	unsigned i;
 	unsigned byte_cnt = data->blocksize * data->blocks;
 	unsigned *buff;
+	unsigned aligned;
+	unsigned word;
 	unsigned timeout = timer_get_us() +  0xffffff;
 
 	if (data->flags & MMC_DATA_READ) {
 		buff = (unsigned int *)data->b.dest;
+		aligned = !(PT_TO_U32(buff) & 0x3);
 		for (i = 0; i < (byte_cnt >> 2); i++) {
-			while ((readl(&mmchost->reg->status) & (1 << 2)) \
-				   && (timer_get_us() < timeout)) {
+			while (readl(&mmchost->reg->status) & (1 << 2)) {
+				if (timer_get_us() > timeout)
+					goto out;
 			}
-			if (readl(&mmchost->reg->status) & (1 << 2))
-				goto out;
-			buff[i] = readl(sunxi_get_iobase(mmchost->database));
-			timeout = timer_get_us() + 0xffffff;
+			word = readl(sunxi_get_iobase(mmchost->database));
+			if (aligned)
+				buff[i] = word;
+			else
+				memcpy((char *)buff + (i << 2), &word, 4);
 		}
 	} else {
 		buff = (unsigned int *)data->b.src;
+		aligned = !(PT_TO_U32(buff) & 0x3);
 		for (i = 0; i < (byte_cnt >> 2); i++) {
-			while ((readl(&mmchost->reg->status) & (1 << 3)) \
-					&& (timer_get_us() < timeout)) {
+			while (readl(&mmchost->reg->status) & (1 << 3)) {
+				if (timer_get_us() > timeout)
+					goto out;
 			}
-			if (readl(&mmchost->reg->status) & (1 << 3))
-				goto out;
-			writel(buff[i], sunxi_get_iobase(mmchost->database));
-			timeout = timer_get_us() +  0xffffff;
+			if (aligned)
+				word = buff[i];
+			else
+				memcpy(&word, (char *)buff + (i << 2), 4);
+			writel(word, sunxi_get_iobase(mmchost->database));
 		}
 	}
 
-out:
-	if (timer_get_us() >= timeout) {
-		mmcinfo("mmc %d transfer by cpu failed\n", mmchost->mmc_no);
-		return -1;
-	}
-
 	return 0;
+
+out:
+	mmcinfo("mmc %d transfer by cpu failed\n", mmchost->mmc_no);
+	return -1;
 }
 
 static int mmc_trans_data_by_dma(struct mmc *mmc, struct mmc_data *data)
@@ -1129,9 +1172,19 @@ static int mmc_trans_data_by_dma(struct mmc *mmc, struct mmc_data *data)
 		remain = SDXC_DES_BUFFER_MAX_LEN;
 
 	pdes = mmchost->pdes;
+	if (buff_frag_num > SDXC_DES_NUM) {
+		mmcinfo("mmc %d %u bytes exceed the descriptor ring\n",
+			mmchost->mmc_no, byte_cnt);
+		return -1;
+	}
 
-	if (data->flags & MMC_DATA_WRITE)
-		OSAL_CacheRangeFlush(buff, (unsigned long)byte_cnt, 0);
+	/*
+	 * write back the buffer for both directions: for reads, dirty lines
+	 * could otherwise be evicted over the DMA data, and the lines shared
+	 * with neighbouring data at either end must be clean before they are
+	 * invalidated once the transfer is over
+	 */
+	OSAL_CacheRangeFlush(buff, (unsigned long)byte_cnt, 0);
 	for (i = 0; i < buff_frag_num; i++, des_idx++) {
 		memset((void *)&pdes[des_idx], 0, sizeof(struct sunxi_mmc_des));
 		pdes[des_idx].des_chain = 1;
@@ -1158,13 +1211,13 @@ static int mmc_trans_data_by_dma(struct mmc *mmc, struct mmc_data *data)
 		}
 		mmcdbg("mmc %d frag %u, remain %u, des[%u](%x): "
 		       "[0] = %x, [1] = %x, [2] = %x, [3] = %x\n",
-		       mmchost->mmc_no, i, remain, des_idx, (u32)&pdes[des_idx],
+		       mmchost->mmc_no, i, remain, des_idx, (u32)(ulong)&pdes[des_idx],
 		       (u32)((u32 *)&pdes[des_idx])[0],
 		       (u32)((u32 *)&pdes[des_idx])[1],
 		       (u32)((u32 *)&pdes[des_idx])[2],
 		       (u32)((u32 *)&pdes[des_idx])[3]);
 	}
-	OSAL_CacheRangeFlush(pdes, sizeof(struct sunxi_mmc_des) * (des_idx+1), 0);
+	OSAL_CacheRangeFlush(pdes, sizeof(struct sunxi_mmc_des) * des_idx, 0);
 	WR_MB();
 	/*
 	 * GCTRLREG
@@ -1212,16 +1265,34 @@ static int mmc_trans_data_by_dma(struct mmc *mmc, struct mmc_data *data)
 	return 0;
 }
 
-static int mmc_send_cmd(struct mmc *mmc, struct mmc_cmd *cmd,
-			struct mmc_data *data)
+static int mmc_send_cmd_end(struct mmc *mmc, struct mmc_cmd *cmd,
+			    struct mmc_data *data, int error);
+
+/* IDMAC needs word aligned buffers, PIO handles the rest */
+static int mmc_data_use_dma(struct mmc_data *data)
+{
+#ifdef MMC_TRANS_BY_DMA
+	return data->blocksize * data->blocks > 512 &&
+	       !(PT_TO_U32(data->b.dest) & 0x3);
+#else
+	return 0;
+#endif
+}
+
+/*
+ * first half of a command: issue it, set up or do (PIO) its data transfer,
+ * and wait for the command to complete; data transfers set up for IDMAC
+ * are still running when it returns 0, mmc_send_cmd_wait() ends them.
+ * On error, the host is already cleaned up.
+ */
+static int mmc_send_cmd_start(struct mmc *mmc, struct mmc_cmd *cmd,
+			      struct mmc_data *data)
 {
 	struct sunxi_mmc_host *mmchost = (struct sunxi_mmc_host *)mmc->priv;
 	unsigned int cmdval	    = 0x80000000;
 	unsigned int timeout	   = 0;
 	int error		       = 0;
 	unsigned int status	    = 0;
-	unsigned int usedma	    = 0;
-	unsigned int bytecnt	   = 0;
 
 	if (mmchost->fatal_err) {
 		mmcinfo("mmc %d Found fatal err,so no send cmd\n",
@@ -1231,8 +1302,6 @@ static int mmc_send_cmd(struct mmc *mmc, struct mmc_cmd *cmd,
 	if (cmd->resp_type & MMC_RSP_BUSY)
 		mmcdbg("mmc %d cmd %u check rsp busy\n", mmchost->mmc_no,
 		       cmd->cmdidx);
-	if ((cmd->cmdidx == 12) && !(cmd->flags & MMC_CMD_MANUAL))
-		return 0;
 	/*
 	 * CMDREG
 	 * CMD[5:0]     : Command index
@@ -1258,13 +1327,6 @@ static int mmc_send_cmd(struct mmc *mmc, struct mmc_cmd *cmd,
 	if (cmd->resp_type & MMC_RSP_CRC)
 		cmdval |= (1 << 8);
 	if (data) {
-		if (PT_TO_U32(data->b.dest) & 0x3) {
-			mmcinfo("mmc %d dest is not 4 byte align\n",
-				mmchost->mmc_no);
-			error = -1;
-			goto out;
-		}
-
 		cmdval |= (1 << 9) | (1 << 13);
 		if (data->flags & MMC_DATA_WRITE)
 			cmdval |= (1 << 10);
@@ -1292,24 +1354,21 @@ static int mmc_send_cmd(struct mmc *mmc, struct mmc_cmd *cmd,
 	 */
 	if (data) {
 		int ret = 0;
-		bytecnt = data->blocksize * data->blocks;
 		mmcdbg("mmc %d trans data %u bytes\n", mmchost->mmc_no,
-		       bytecnt);
-#ifdef MMC_TRANS_BY_DMA
-		if (bytecnt > 512) {
-#else
-		if (0) {
-#endif
-			usedma = 1;
+		       data->blocksize * data->blocks);
+		if (mmc_data_use_dma(data)) {
 			writel(readl(&mmchost->reg->gctrl) & (~0x80000000),
 			       &mmchost->reg->gctrl);
 			ret = mmc_trans_data_by_dma(mmc, data);
 			writel(cmdval | cmd->cmdidx, &mmchost->reg->cmd);
 		} else {
+			PMU_SCOPE(scope, "mmc_trans_by_cpu");
 			writel(readl(&mmchost->reg->gctrl) | 0x80000000,
 			       &mmchost->reg->gctrl);
 			writel(cmdval | cmd->cmdidx, &mmchost->reg->cmd);
+			pmu_begin(&scope);
 			ret = mmc_trans_data_by_cpu(mmc, data);
+			pmu_end(&scope);
 		}
 		if (ret) {
 			mmcinfo("mmc %d Transfer failed\n", mmchost->mmc_no);
@@ -1333,6 +1392,21 @@ static int mmc_send_cmd(struct mmc *mmc, struct mmc_cmd *cmd,
 		}
 	} while (!(status & 0x4));
 
+	return 0;
+out:
+	return mmc_send_cmd_end(mmc, cmd, data, error);
+}
+
+/* second half of a command started by mmc_send_cmd_start() */
+static int mmc_send_cmd_wait(struct mmc *mmc, struct mmc_cmd *cmd,
+			     struct mmc_data *data)
+{
+	struct sunxi_mmc_host *mmchost = (struct sunxi_mmc_host *)mmc->priv;
+	unsigned int timeout	   = 0;
+	int error		       = 0;
+	unsigned int status	    = 0;
+	unsigned int usedma	    = data && mmc_data_use_dma(data);
+
 	if (data) {
 		unsigned done = 0;
 		timeout       =  timer_get_us() + (usedma ? 0xffffff : 0xffff);
@@ -1402,7 +1476,21 @@ static int mmc_send_cmd(struct mmc *mmc, struct mmc_cmd *cmd,
 		mmcdbg("mmc %d resp 0x%x\n", mmchost->mmc_no, cmd->response[0]);
 	}
 out:
-	if (data && usedma) {
+	return mmc_send_cmd_end(mmc, cmd, data, error);
+}
+
+/*
+ * common tail of a command: stop IDMAC, reset the host after an error and
+ * clear the interrupt status; returns -1 on error, 0 otherwise
+ */
+static int mmc_send_cmd_end(struct mmc *mmc, struct mmc_cmd *cmd,
+			    struct mmc_data *data, int error)
+{
+	struct sunxi_mmc_host *mmchost = (struct sunxi_mmc_host *)mmc->priv;
+	unsigned int timeout	   = 0;
+	unsigned int status	    = 0;
+
+	if (data && mmc_data_use_dma(data)) {
 		/* IDMASTAREG
 		 * IDST[0] : idma tx int
 		 * IDST[1] : idma rx int
@@ -1443,6 +1531,16 @@ out:
 		return 0;
 }
 
+static int mmc_send_cmd(struct mmc *mmc, struct mmc_cmd *cmd,
+			struct mmc_data *data)
+{
+	if ((cmd->cmdidx == 12) && !(cmd->flags & MMC_CMD_MANUAL))
+		return 0;
+	if (mmc_send_cmd_start(mmc, cmd, data))
+		return -1;
+	return mmc_send_cmd_wait(mmc, cmd, data);
+}
+
 void mmc_update_host_caps_f(int sdc_no)
 {
 #ifndef FPGA_PLATFORM
@@ -1495,12 +1593,10 @@ void mmc_update_host_caps_r(int sdc_no)
 		       IOMEM_ADDR(SUNXI_PIO_BASE + GPIO_POW_MODE_REG));
 	}
 
+	/* without tuning data sunxi_mmc_execute_tuning() sweeps the sample delay */
 	if (((priv_info->ext_para0 & 0xFF000000) != EXT_PARA0_ID)
-		|| !(priv_info->ext_para0 & EXT_PARA0_TUNING_SUCCESS_FLAG)) {
-		mmcinfo("force 25m\n");
-		mmc->f_max = 25000000;
-		mmc->f_max_ddr = 25000000;
-	}
+		|| !(priv_info->ext_para0 & EXT_PARA0_TUNING_SUCCESS_FLAG))
+		mmcinfo("no tuning para\n");
 
 	mmcdbg("%s mmc->f_max:%d\n", __func__, mmc->f_max);
 	mmcdbg("%s mmc->f_max_ddr:%d\n", __func__, mmc->f_max_ddr);
@@ -1511,6 +1607,138 @@ void mmc_update_host_caps_r(int sdc_no)
 		readl(IOMEM_ADDR(SUNXI_PIO_BASE + GPIO_POW_MODE_REG)));
 #endif
 }
+#ifndef FPGA_PLATFORM
+/* blocks of boot0 itself read back at each sample delay */
+#define TUNING_START_BLK	BOOT0_SDMMC_START_ADDR
+#define TUNING_BLKS		16
+
+extern int mmc_read_blocks(struct mmc *mmc, void *dst, unsigned long start,
+			   unsigned blkcnt);
+
+static int mmc_tuning_read(struct mmc *mmc, u8 *buf)
+{
+	struct mmc_cmd cmd;
+
+	if (mmc_read_blocks(mmc, buf, TUNING_START_BLK, TUNING_BLKS) ==
+	    TUNING_BLKS)
+		return 0;
+
+	/* the card may still be sending data after a crc error */
+	cmd.cmdidx    = MMC_CMD_STOP_TRANSMISSION;
+	cmd.cmdarg    = 0;
+	cmd.resp_type = MMC_RSP_R1b;
+	cmd.flags     = MMC_CMD_MANUAL;
+	mmc_send_cmd(mmc, &cmd, NULL);
+
+	return -1;
+}
+
+/* pass a tuned sample delay to the next stage through storage_data */
+static void mmc_save_tuning(struct mmc *mmc, u32 freq_id, u8 sdly)
+{
+	struct boot_sdmmc_private_info_t *priv_info;
+
+	if (!mmc_config_addr)
+		return;
+
+	priv_info = (struct boot_sdmmc_private_info_t *)sunxi_get_iobase(
+		mmc_config_addr + SDMMC_PRIV_INFO_ADDR_OFFSET);
+	mmc_set_tune_sdly(&priv_info->tune_sdly, mmc->speed_mode, freq_id,
+			  sdly);
+	priv_info->card_type = IS_SD(mmc) ? CARD_TYPE_SD : CARD_TYPE_MMC;
+	if ((priv_info->ext_para0 & 0xFF000000) != EXT_PARA0_ID)
+		priv_info->ext_para0 = EXT_PARA0_ID;
+	priv_info->ext_para0 |= EXT_PARA0_TUNING_SUCCESS_FLAG;
+}
+
+/*
+ * sweep the sample delay of the current speed mode and clock: boot0 is read
+ * at 25MHz as reference, then at each delay; the middle of the longest run
+ * of delays reading it back intact is kept
+ */
+static int sunxi_mmc_execute_tuning(struct mmc *mmc)
+{
+	struct sunxi_mmc_host *mmchost = (struct sunxi_mmc_host *)mmc->priv;
+	struct boot_sdmmc_private_info_t *priv_info =
+		&((struct sunxi_sdmmc_parameter_region *)mmc_arg_addr)->info;
+	struct sunxi_sdmmc_parameter_region_header *region_header =
+		&((struct sunxi_sdmmc_parameter_region *)mmc_arg_addr)->header;
+	u8 *ref	       = (u8 *)TUNING_BUF_IN_SDRAM;
+	u8 *buf	       = ref + TUNING_BLKS * 512;
+	unsigned clock = mmc->clock;
+	u32 freq       = mmc_freq_id(clock);
+	u32 dly, dly_min, dly_max, run = 0, best = 0, best_run = 0, sdly;
+	u8 old_dly;
+
+	/* delays tuned or fixed at production are used as they are */
+	if (region_header->magic == SDMMC_PARAMETER_MAGIC) {
+		if (((priv_info->ext_para0 & 0xFF000000) == EXT_PARA0_ID) &&
+		    (priv_info->ext_para0 & EXT_PARA0_TUNING_SUCCESS_FLAG))
+			return 0;
+		if (priv_info->boot_mmc_cfg.boot0_para &
+		    (BOOT0_PARA_USE_INTERNAL_DEFAULT_TIMING_PARA |
+		     BOOT0_PARA_USE_EXTERNAL_INPUT_TIMING_PARA))
+			return 0;
+	}
+
+	if (mmchost->timing_mode == SUNXI_MMC_TIMING_MODE_1) {
+		/* sample phase */
+		dly_min = 0;
+		dly_max = 3;
+	} else if (mmchost->timing_mode == SUNXI_MMC_TIMING_MODE_4) {
+		/* sample delay chain, 0 means no tuning data */
+		dly_min = 1;
+		dly_max = 63;
+	} else
+		return 0;
+
+	mmc->clock = 25000000;
+	mmc_set_ios(mmc);
+	if (mmc_tuning_read(mmc, ref)) {
+		mmcinfo("mmc %d read tuning reference failed\n",
+			mmchost->mmc_no);
+		return -1;
+	}
+	mmc->clock = clock;
+	mmc_set_ios(mmc);
+
+	old_dly = mmc_get_tune_sdly(&priv_info->tune_sdly, mmc->speed_mode,
+				    freq);
+	for (dly = dly_min; dly <= dly_max; dly++) {
+		mmc_set_tune_sdly(&priv_info->tune_sdly, mmc->speed_mode, freq,
+				  dly);
+		mmc_config_delay(mmchost, mmc->speed_mode, freq);
+		mmc_update_phase(mmc);
+		if (!mmc_tuning_read(mmc, buf) &&
+		    !memcmp(ref, buf, TUNING_BLKS * 512)) {
+			if (++run > best_run) {
+				best_run = run;
+				best	 = dly + 1 - run;
+			}
+		} else
+			run = 0;
+	}
+
+	if (!best_run) {
+		mmc_set_tune_sdly(&priv_info->tune_sdly, mmc->speed_mode, freq,
+				  old_dly);
+		mmc_config_delay(mmchost, mmc->speed_mode, freq);
+		mmc_update_phase(mmc);
+		return -1;
+	}
+
+	sdly = best + best_run / 2;
+	mmc_set_tune_sdly(&priv_info->tune_sdly, mmc->speed_mode, freq, sdly);
+	mmc_config_delay(mmchost, mmc->speed_mode, freq);
+	mmc_update_phase(mmc);
+	mmc_save_tuning(mmc, freq, sdly);
+	mmcinfo("mmc %d sdly %u (%u~%u ok)\n", mmchost->mmc_no, sdly, best,
+		best + best_run - 1);
+
+	return 0;
+}
+#endif
+
 int sunxi_mmc_init(int sdc_no, unsigned bus_width,
 		   const normal_gpio_cfg *gpio_info, int offset,
 		   void *extra_data)
@@ -1533,9 +1761,14 @@ int sunxi_mmc_init(int sdc_no, unsigned bus_width,
 	strcpy(mmc->name, "SUNXI SD/MMC");
 	mmc->priv	 = &mmc_host[sdc_no];
 	mmc->send_cmd     = mmc_send_cmd;
+	mmc->send_cmd_start = mmc_send_cmd_start;
+	mmc->send_cmd_wait  = mmc_send_cmd_wait;
 	mmc->set_ios      = mmc_set_ios;
 	mmc->init	 = mmc_core_init;
 	mmc->update_phase = mmc_update_phase;
+#ifndef FPGA_PLATFORM
+	mmc->execute_tuning = sunxi_mmc_execute_tuning;
+#endif
 
 	mmc->voltages = MMC_VDD_29_30 | MMC_VDD_30_31 | MMC_VDD_31_32 |
 			MMC_VDD_32_33 | MMC_VDD_33_34 | MMC_VDD_34_35 |
@@ -1554,6 +1787,8 @@ int sunxi_mmc_init(int sdc_no, unsigned bus_width,
 	mmc->f_max_ddr = 50000000;
 	mmc_update_host_caps_f(sdc_no);
 	mmc->control_num = sdc_no;
+	/* one transfer must fit in the descriptor ring */
+	mmc->b_max = SDXC_DES_MAX_BLKS;
 
 	mmc_host[sdc_no].pdes = (struct sunxi_mmc_des *)DMAC_DES_BASE_IN_SDRAM;
 	if (mmc_resource_init(sdc_no)) {
@@ -20,6 +20,9 @@ struct sunxi_mmc_des {
 
 #define SDXC_DES_NUM_SHIFT 12
 #define SDXC_DES_BUFFER_MAX_LEN	(1 << SDXC_DES_NUM_SHIFT)
+/* descriptors in the ring at DMAC_DES_BASE_IN_SDRAM, bounds a single transfer (b_max) */
+#define SDXC_DES_NUM		2048
+#define SDXC_DES_MAX_BLKS	((SDXC_DES_NUM << SDXC_DES_NUM_SHIFT) >> 9)
 	u32 data_buf1_sz:16, data_buf2_sz:16;
 
 	u32 buf_addr_ptr1;
@@ -57,9 +57,9 @@
 #define mmcdbg(fmt...)	printf("[mmc]: "fmt)
 #define mmcmsg(fmt...)	printf(fmt)
 #else
-#define mmcinfo(fmt...)	printf("[mmc]: "fmt)
-#define mmcdbg(fmt...)
-#define mmcmsg(fmt...)
+#define mmcinfo(fmt...)	pr_info("[mmc]: "fmt)
+#define mmcdbg(fmt...)	pr_debug("[mmc]: "fmt)
+#define mmcmsg(fmt...)	pr_debug(fmt)
 #endif
 
 /*#define readb(addr)           (*((volatile unsigned char  *)(addr)))*/
@@ -70,7 +70,9 @@
 /*#define writel(v, addr)       (*((volatile unsigned long  *)(addr)) = (unsigned long)(v))*/
 
 #define DMAC_DES_BASE_IN_SRAM		(0x20000 + 0xC000)
-#define DMAC_DES_BASE_IN_SDRAM		(0x42000000)
+#define DMAC_DES_BASE_IN_SDRAM		(CONFIG_MMC_DES_BASE)
+/* reference and sample data of the sample delay sweep */
+#define TUNING_BUF_IN_SDRAM		(CONFIG_MMC_TUNING_BASE)
 #define DRAM_START_ADDR				(0x40000000)
 
 #define DRIVER_VER  "2021-04-2 16:45"
@@ -63,11 +63,27 @@ void sunxi_serial_init(int uart_port, void *gpio_cfg, int gpio_max)
 
 void sunxi_serial_putc (char c)
 {
-	while ((serial_ctrl_base->lsr & (1 << 6)) == 0)
+	while ((serial_ctrl_base->lsr & UART_LSR_TEMT) == 0)
 		;
 	serial_ctrl_base->thr = c;
 }
 
+/* queue c if the TX FIFO has room, returns 0 if it was queued */
+int sunxi_serial_try_putc(char c)
+{
+	if (!(serial_ctrl_base->usr & UART_USR_TFNF))
+		return -1;
+	serial_ctrl_base->thr = c;
+	return 0;
+}
+
+/* wait until everything queued is on the line */
+void sunxi_serial_flush(void)
+{
+	while ((serial_ctrl_base->lsr & UART_LSR_TEMT) == 0)
+		;
+}
+
 char sunxi_serial_getc (void)
 {
 	while ((serial_ctrl_base->lsr & 1) == 0)
@@ -94,7 +94,7 @@ static int spi_flash_wait_till_ready(void)
 			return 0;
 	}
 
-	printf("SF: Timeout!\n");
+	pr_err("SF: Timeout!\n");
 	return -1;
 }
 
@@ -217,7 +217,7 @@ static int GigaDevice_quad_enable(void)
 	/* read SR and check it */
 	ret = read_sr1(&qeb_status);
 	if (!(ret >= 0 && (qeb_status & STATUS_QEB_GIGA))) {
-		printf("SF: Macronix SR Quad bit not clear\n");
+		pr_err("SF: Macronix SR Quad bit not clear\n");
 		return -1;
 	}
 	return ret;
@@ -244,7 +244,7 @@ static int macronix_quad_enable(void)
 	/* read SR and check it */
 	ret = read_sr(&qeb_status);
 	if (!(ret >= 0 && (qeb_status & STATUS_QEB_MXIC))) {
-		printf("SF: Macronix SR Quad bit not clear\n");
+		pr_err("SF: Macronix SR Quad bit not clear\n");
 		return -1;
 	}
 	return ret;
@@ -269,7 +269,7 @@ static int spansion_quad_enable(void)
 	/* read CR and check it */
 	ret = read_cr(&qeb_status);
 	if (!(ret >= 0 && (qeb_status & STATUS_QEB_WINSPAN))) {
-		printf("SF: Spansion CR Quad bit not clear\n");
+		pr_err("SF: Spansion CR Quad bit not clear\n");
 		return -1;
 	}
 
@@ -296,7 +296,7 @@ static int stmicro_quad_enable(void)
 	// read CR and check it
 	ret = read_cr1(&qeb_status);
 	if (!(ret >= 0 && (qeb_status & STATUS_QEB_STMICRO))) {
-		printf("SF: Spansion CR Quad bit not clear\n");
+		pr_err("SF: Spansion CR Quad bit not clear\n");
 		return -1;
 	}
 
@@ -310,7 +310,7 @@ static int set_quad_mode(u8 id_0, u8 id_1)
 	case SPI_FLASH_CFI_MFR_MACRONIX:
 	case SPI_FLASH_CFI_MFR_XMC:
 		if (JEDEC_MFR(id_1) >> 4 == 'b') {
-			printf("SF: QEB is volatile for %02xb flash\n", JEDEC_MFR(id_0));
+			pr_warn("SF: QEB is volatile for %02xb flash\n", JEDEC_MFR(id_0));
 			return 0;
 		}
 		return macronix_quad_enable();
@@ -326,7 +326,7 @@ static int set_quad_mode(u8 id_0, u8 id_1)
 //		return stmicro_quad_enable();
 //		return 0;
 	default:
-		printf("SF: Need set QEB func for %02x flash\n",
+		pr_warn("SF: Need set QEB func for %02x flash\n",
 		       JEDEC_MFR(id_0));
 		return -1;
 	}
@@ -371,9 +371,9 @@ static int spinor_enter_4bytes_addr(int enable)
 
 	read_cr(&buf);
 	if ((buf >> 5)  & 0x1)
-		printf("4byte mode ok\n");
+		pr_debug("4byte mode ok\n");
 	else {
-		printf("4byte mode error\n");
+		pr_err("4byte mode error\n");
 		return 0;
 	}
 	return 1;
@@ -426,7 +426,7 @@ int spinor_init(int stage)
 		}
 	}
 
-	printf("spinor id is: %02x %02x %02x, read cmd: %02x\n",
+	pr_info("spinor id is: %02x %02x %02x, read cmd: %02x\n",
 		id[0], id[1], id[2], read_cmd);
 
 	/*
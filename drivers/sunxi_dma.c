@@ -39,6 +39,19 @@ static int dma_init = -1;
 static sunxi_dma_source   dma_channal_source[SUNXI_DMA_MAX];
 __attribute__((section(".data")))
 sunxi_dma_desc g_sunxi_dma_desc[SUNXI_DMA_MAX];
+/* nodes of the sunxi_dma_list_add() lists of all channels */
+__attribute__((section(".data")))
+static sunxi_dma_desc dma_desc_pool[SUNXI_DMA_DESC_NR];
+static uint dma_desc_used;
+
+static void sunxi_dma_list_put(sunxi_dma_source *dma_source)
+{
+	dma_desc_used &= ~dma_source->list_mask;
+	dma_source->list_mask = 0;
+	dma_source->list_head = NULL;
+	dma_source->list_tail = NULL;
+	dma_source->list_len = 0;
+}
 
 void sunxi_dma_reg_func(void *p)
 {
@@ -130,6 +143,7 @@ void sunxi_dma_exit(void)
 			sunxi_dma_disable_int(hdma);
 			sunxi_dma_free_int(hdma);
 			writel(0, &dma_channal_source[i].channal->enable);
+			sunxi_dma_list_put(&dma_channal_source[i]);
 			dma_channal_source[i].used   = 0;
 		}
 	}
@@ -197,6 +211,7 @@ int sunxi_dma_release(ulong hdma)
 	sunxi_dma_disable_int(hdma);
 	sunxi_dma_free_int(hdma);
 
+	sunxi_dma_list_put(dma_source);
 	dma_source->used   = 0;
 
 	return 0;
@@ -256,6 +271,112 @@ int sunxi_dma_start(ulong hdma, phys_addr_t saddr, phys_addr_t daddr, uint bytes
 	return 0;
 }
 
+static void sunxi_dma_desc_cfg(sunxi_dma_desc *desc, sunxi_dma_set *cfg)
+{
+	desc->config = readl(&cfg->channal_cfg);
+	desc->commit_para = (cfg->wait_cyc & 0xff) | (cfg->data_block_size & 0xff) << 8;
+}
+
+int sunxi_dma_list_add(ulong hdma, phys_addr_t saddr, phys_addr_t daddr, uint bytes,
+		       sunxi_dma_set *cfg)
+{
+	sunxi_dma_source *dma_source = (sunxi_dma_source *)hdma;
+	sunxi_dma_desc *desc;
+	uint n, i;
+
+	if (!dma_source->used || !bytes)
+		return -1;
+
+	/* a node each SUNXI_DMA_NODE_MAX bytes, taken all or none */
+	n = (bytes + SUNXI_DMA_NODE_MAX - 1) / SUNXI_DMA_NODE_MAX;
+	for (i = 0; i < SUNXI_DMA_DESC_NR && n; i++)
+		if (!(dma_desc_used & (1 << i)))
+			n--;
+	if (n)
+		return -1;
+
+	for (i = 0; bytes; i++) {
+		uint len = min(bytes, (uint)SUNXI_DMA_NODE_MAX);
+
+		if (dma_desc_used & (1 << i))
+			continue;
+		dma_desc_used |= 1 << i;
+		dma_source->list_mask |= 1 << i;
+		desc = &dma_desc_pool[i];
+
+		if (cfg) {
+			sunxi_dma_desc_cfg(desc, cfg);
+		} else {
+			desc->config = dma_source->desc->config;
+			desc->commit_para = dma_source->desc->commit_para;
+		}
+		desc->source_addr = saddr;
+		desc->dest_addr = daddr;
+		desc->byte_count = len;
+		desc->link = SUNXI_DMA_LINK_NULL;
+
+		if (dma_source->list_tail)
+			dma_source->list_tail->link = sunxi_get_lw32_addr(desc);
+		else
+			dma_source->list_head = desc;
+		dma_source->list_tail = desc;
+		dma_source->list_len++;
+
+		/* IO mode ends stay on the FIFO */
+		if (!(desc->config & DMAC_CFG_SRC_IO_MODE))
+			saddr += len;
+		if (!(desc->config & DMAC_CFG_DEST_IO_MODE))
+			daddr += len;
+		bytes -= len;
+	}
+
+	return dma_source->list_len - 1;
+}
+
+int sunxi_dma_list_start(ulong hdma)
+{
+	sunxi_dma_source *dma_source = (sunxi_dma_source *)hdma;
+	sunxi_dma_channal_reg *channal = dma_source->channal;
+
+	if (!dma_source->used || !dma_source->list_head)
+		return -1;
+
+	flush_dcache_range((ulong)dma_desc_pool, (ulong)dma_desc_pool + sizeof(dma_desc_pool));
+
+	writel(sunxi_get_lw32_addr(dma_source->list_head), &channal->desc_addr);
+	writel(1, &channal->enable);
+
+	return 0;
+}
+
+int sunxi_dma_list_done(ulong hdma, int node)
+{
+	sunxi_dma_source *dma_source = (sunxi_dma_source *)hdma;
+	int busy = sunxi_dma_querystatus(hdma);
+
+	if (busy < 0 || node >= (int)dma_source->list_len)
+		return -1;
+	if (!busy)
+		return 1;
+	if (node < 0)
+		return 0;
+
+	return readl(&dma_source->channal->pkg_num) > node;
+}
+
+int sunxi_dma_list_free(ulong hdma)
+{
+	sunxi_dma_source *dma_source = (sunxi_dma_source *)hdma;
+
+	if (sunxi_dma_querystatus(hdma))
+		return -1;
+
+	sunxi_dma_list_put(dma_source);
+
+	return 0;
+}
+
+/* the channel's list nodes go back to the pool, busy or not */
 int sunxi_dma_stop(ulong hdma)
 {
 	sunxi_dma_source *dma_source = (sunxi_dma_source *)hdma;
@@ -264,6 +385,7 @@ int sunxi_dma_stop(ulong hdma)
 	if (!dma_source->used)
 		return -1;
 	writel(0, &channal->enable);
+	sunxi_dma_list_put(dma_source);
 
 	return 0;
 }
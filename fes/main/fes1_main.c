@@ -24,6 +24,7 @@ int main(void)
 	int dram_size=0;
 	int status;
 
+	vector_init();
 	sunxi_serial_init(fes1_head.prvt_head.uart_port, (void *)fes1_head.prvt_head.uart_ctrl, 2);
 	printf("fes begin commit:%s\n", fes1_head.hash);
 	status = sunxi_board_init();
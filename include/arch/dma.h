@@ -102,6 +102,9 @@ typedef struct {
 	unsigned int dst_data_width : 2;
 	unsigned int reserved1 : 5;
 } sunxi_dma_channal_config;
+/* the addr_mode bits of the config word */
+#define DMAC_CFG_SRC_IO_MODE	(1 << 8)
+#define DMAC_CFG_DEST_IO_MODE	(1 << 24)
 
 #else
 #error "DMA definition not available for this architecture"
@@ -128,10 +131,11 @@ typedef struct {
 	unsigned int cur_dst_addr;
 	unsigned int left_bytes;
 	unsigned int parameters;
-	unsigned int mode;
-	unsigned int fdesc_addr;
-	unsigned int pkg_num;
-	unsigned int res[5];
+	unsigned int res0[2];
+	unsigned int mode;		/* 0x28 */
+	unsigned int fdesc_addr;	/* 0x2c */
+	unsigned int pkg_num;		/* 0x30 descriptors done since the start */
+	unsigned int res1[3];
 } sunxi_dma_channal_reg;
 
 typedef struct {
@@ -159,6 +163,11 @@ typedef struct sunxi_dma_source_t {
 	unsigned int reserved;
 	sunxi_dma_desc *desc;
 	struct dma_irq_handler dma_func;
+	/* descriptor list of sunxi_dma_list_add(), in the shared pool */
+	sunxi_dma_desc *list_head;
+	sunxi_dma_desc *list_tail;
+	unsigned int list_len;
+	unsigned int list_mask;		/* pool entries it holds */
 } sunxi_dma_source;
 
 #define DMA_RST_OFS 16
@@ -176,6 +185,23 @@ extern int sunxi_dma_start(unsigned long hdma, phys_addr_t saddr, phys_addr_t da
 extern int sunxi_dma_stop(unsigned long hdma);
 extern int sunxi_dma_querystatus(unsigned long hdma);
 
+/*
+ * scatter-gather: nodes are added to the channel's list, cfg NULL takes
+ * the one of sunxi_dma_setting(), and the list runs with one start.
+ * sunxi_dma_list_add() returns the number of the (last) node it added,
+ * sunxi_dma_list_done() is 1 once that node, or the whole list for -1,
+ * is through. The nodes go back to the pool with sunxi_dma_list_free()
+ * once the channel is idle, or with sunxi_dma_stop() if it is stuck.
+ */
+#define SUNXI_DMA_DESC_NR	16
+#define SUNXI_DMA_NODE_MAX	(16 << 20)	/* the byte count is 25 bits */
+
+extern int sunxi_dma_list_add(ulong hdma, phys_addr_t saddr, phys_addr_t daddr,
+			      unsigned int bytes, sunxi_dma_set *cfg);
+extern int sunxi_dma_list_start(ulong hdma);
+extern int sunxi_dma_list_done(ulong hdma, int node);
+extern int sunxi_dma_list_free(ulong hdma);
+
 extern int sunxi_dma_install_int(ulong hdma, void *p);
 extern int sunxi_dma_disable_int(ulong hdma);
 
@@ -10,10 +10,17 @@
 #define _ASM_RISCV_CSR_H
 
 #include <asm/asm.h>
-/*#include <linux/const.h>*/
+
+/* as linux/const.h */
+#ifdef __ASSEMBLY__
+#define _AC(X, Y)	X
+#else
+#define _AC(X, Y)	(X##Y)
+#endif
 
 /* Status register flags */
 #define SR_SIE		_AC(0x00000002, UL) /* Supervisor Interrupt Enable */
+#define SR_MIE		_AC(0x00000008, UL) /* Machine Interrupt Enable */
 #define SR_SPIE		_AC(0x00000020, UL) /* Previous Supervisor IE */
 #define SR_SPP		_AC(0x00000100, UL) /* Previously Supervisor */
 #define SR_SUM		_AC(0x00040000, UL) /* Supervisor User Memory Access */
@@ -24,6 +31,11 @@
 #define SR_FS_CLEAN	_AC(0x00004000, UL)
 #define SR_FS_DIRTY	_AC(0x00006000, UL)
 
+#define SR_VS		_AC(0x00000600, UL) /* Vector Status, RVV 1.0 */
+#define SR_VS_INITIAL	_AC(0x00000200, UL)
+#define SR_VS_THEAD	_AC(0x01800000, UL) /* the same on the c906, RVV 0.7.1 */
+#define SR_VS_THEAD_INITIAL _AC(0x00800000, UL)
+
 #define SR_XS		_AC(0x00018000, UL) /* Extension Status */
 #define SR_XS_OFF	_AC(0x00000000, UL)
 #define SR_XS_INITIAL	_AC(0x00008000, UL)
@@ -72,6 +84,7 @@
 
 /* SIE (Interrupt Enable) and SIP (Interrupt Pending) flags */
 #define MIE_MSIE		(_AC(0x1, UL) << IRQ_M_SOFT)
+#define MIE_MTIE		(_AC(0x1, UL) << IRQ_M_TIMER)
 #define SIE_SSIE		(_AC(0x1, UL) << IRQ_S_SOFT)
 #define SIE_STIE		(_AC(0x1, UL) << IRQ_S_TIMER)
 #define SIE_SEIE		(_AC(0x1, UL) << IRQ_S_EXT)
@@ -103,8 +116,12 @@
 #define CSR_CYCLEH		0xc80
 #define CSR_TIMEH		0xc81
 #define CSR_INSTRETH		0xc82
+#define CSR_MVENDORID		0xf11
 #define CSR_MHARTID		0xf14
 
+#define MISA_V			(1 << ('V' - 'A'))
+#define MVENDORID_THEAD		0x5b7
+
 #define C910_HART_COUNT   16
 #define C910_HART_STACK_SIZE   8192
 
@@ -123,6 +140,21 @@
 #define CSR_MRMR         0x7c6
 #define CSR_MRVBR        0x7c7
 
+/* performance monitor, counter n counts event n - 2 on the c906 */
+#define CSR_MCYCLE		0xb00
+#define CSR_MINSTRET		0xb02
+#define CSR_MHPMCOUNTER4	0xb04
+#define CSR_MHPMCOUNTER15	0xb0f
+#define CSR_MHPMCOUNTER17	0xb11
+#define CSR_MCOUNTINHIBIT	0x320
+#define CSR_MHPMEVENT4		0x324
+#define CSR_MHPMEVENT15		0x32f
+#define CSR_MHPMEVENT17		0x331
+#define HPM_L1I_MISS		0x02
+#define HPM_L1D_READ_MISS	0x0d
+#define HPM_L1D_WRITE_MISS	0x0f
+#define MXSTATUS_PMDM		(1 << 13)	/* no counting in M mode */
+
 #ifndef __ASSEMBLY__
 
 #define csr_swap(csr, val)					\
@@ -0,0 +1,40 @@
+/*
+ * SPDX-License-Identifier:	GPL-2.0+
+ *
+ * Vector kernels for the bulk loops, built with CFG_RISCV_VECTOR=y.
+ * vector_init() looks at misa/mvendorid, turns the vector unit on and
+ * points the vec_* hooks at the RVV 1.0 (rvv_*) or the c906 RVV 0.7.1
+ * (thead_rvv_*) build of arch/riscv/cpu/riscv64/rvv.S; without a vector
+ * unit they stay NULL and the callers keep their scalar loops.
+ */
+
+#ifndef _ASM_RISCV_VECTOR_H
+#define _ASM_RISCV_VECTOR_H
+
+/* below this the scalar loop wins over setting up the vector unit */
+#define VEC_MIN_BYTES	256
+
+#ifndef __ASSEMBLY__
+#include <linux/types.h>
+
+extern void *(*vec_memcpy)(void *dst, const void *src, size_t n);
+extern void *(*vec_memset)(void *s, int c, size_t n);
+extern u32 (*vec_addsum)(u32 sum, const void *buf, u32 size);
+/* word i of addr is patt + i; dram_check returns 0 if all of them are */
+extern void (*vec_dram_fill)(u32 *addr, u32 patt, ulong n);
+extern u32 (*vec_dram_check)(const u32 *addr, u32 patt, ulong n);
+
+void *rvv_memcpy(void *dst, const void *src, size_t n);
+void *rvv_memset(void *s, int c, size_t n);
+u32 rvv_addsum(u32 sum, const void *buf, u32 size);
+void rvv_dram_fill(u32 *addr, u32 patt, ulong n);
+u32 rvv_dram_check(const u32 *addr, u32 patt, ulong n);
+
+void *thead_rvv_memcpy(void *dst, const void *src, size_t n);
+void *thead_rvv_memset(void *s, int c, size_t n);
+u32 thead_rvv_addsum(u32 sum, const void *buf, u32 size);
+void thead_rvv_dram_fill(u32 *addr, u32 patt, ulong n);
+u32 thead_rvv_dram_check(const u32 *addr, u32 patt, ulong n);
+#endif
+
+#endif
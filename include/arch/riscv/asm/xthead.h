@@ -0,0 +1,28 @@
+/*
+ * SPDX-License-Identifier:	GPL-2.0+
+ *
+ * T-Head c906 scalar extensions, built with CFG_RISCV_XTHEAD=y. The
+ * compiler is then given -march=..._xtheadba_xtheadbb_xtheadcondmov_
+ * xtheadmemidx and picks th.addsl for scaled table indexes, th.extu for
+ * zero extension and bitfields, th.lbuia/th.lbuib for the byte stream
+ * reads of the decoders and th.mveqz/th.mvnez for simple selects by
+ * itself; what is here is for the places it won't. boot0_entry.S turns
+ * the extensions on with mxstatus.THEADISAEE before any C runs.
+ */
+
+#ifndef _ASM_RISCV_XTHEAD_H
+#define _ASM_RISCV_XTHEAD_H
+
+/* cond ? a : b without a branch, for selects on a coin toss */
+static inline unsigned long xthead_select(unsigned long cond, unsigned long a,
+					  unsigned long b)
+{
+#ifdef CFG_RISCV_XTHEAD
+	asm("th.mvnez %0, %1, %2" : "+r" (b) : "r" (a), "r" (cond));
+	return b;
+#else
+	return b ^ ((a ^ b) & -(unsigned long)!!cond);
+#endif
+}
+
+#endif
@@ -22,8 +22,15 @@ typedef struct serial_hw
 	volatile unsigned int lsr;		/* 5 */
 	volatile unsigned int msr;		/* 6 */
 	volatile unsigned int sch;		/* 7 */
+	volatile unsigned int res[23];
+	volatile unsigned int usr;		/* 31 */
+	volatile unsigned int tfl;		/* 32 */
+	volatile unsigned int rfl;		/* 33 */
 }serial_hw_t;
 
+#define UART_USR_TFNF		(1 << 1)	/* TX FIFO not full */
+#define UART_LSR_TEMT		(1 << 6)	/* TX FIFO and shifter empty */
+
 #define thr rbr
 #define dll rbr
 #define dlh ier
@@ -44,6 +51,8 @@ typedef struct serial_hw
 
 void sunxi_serial_init(int uart_port, void *gpio_cfg, int gpio_max);
 void sunxi_serial_putc (char c);
+int sunxi_serial_try_putc(char c);
+void sunxi_serial_flush(void);
 char sunxi_serial_getc (void);
 int sunxi_serial_tstc (void);
 
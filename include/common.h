@@ -36,12 +36,82 @@ void mdelay(unsigned long);
 void sdelay(unsigned long loops);
 u32 timer_get_us(void);
 u32 get_sys_ticks(void);
+u64 get_arch_counter(void);
+
+#ifdef CFG_BOOT0_TIMELINE
+void timeline_mark(const char *name);
+void timeline_fdt(void *fdt);
+void timeline_publish(void *fdt);
+#else
+static inline void timeline_mark(const char *name) {}
+static inline void timeline_fdt(void *fdt) {}
+static inline void timeline_publish(void *fdt) {}
+#endif
+
+#ifdef CFG_RISCV_VECTOR
+void vector_init(void);
+#else
+static inline void vector_init(void) {}
+#endif
 
 void print_sys_tick(void);
+#ifdef CFG_BOOT0_CONSOLE_RING
+void console_flush(void);
+void console_log_init(void *base, u32 size);
+#else
+static inline void console_flush(void) {}
+static inline void console_log_init(void *base, u32 size) {}
+#endif
+#ifdef CFG_BOOT0_BINLOG
+void blog_init(void *base, u32 size);
+int blog_printf(const char *fmt, ...);
+#else
+static inline void blog_init(void *base, u32 size) {}
+#define blog_printf	printf
+#endif
 int sunxi_set_printf_debug_mode(u8 debug_level);
 u8 sunxi_get_printf_debug_mode(void);
 void puts(const char *s);
 int printf(const char *fmt, ...);
+
+/*
+ * levelled printf: a call above CFG_LOG_LEVEL is compiled out, format
+ * string included, its arguments are still type checked but not evaluated.
+ *	pr_err		boot0 gives up on what it was doing
+ *	pr_warn		boot0 carries on without it
+ *	pr_info		the normal boot log
+ *	pr_debug	per command/block/inode detail
+ * CFG_LOG_LEVEL=0 keeps only the plain printf()s, 3 when not given. With
+ * CFG_BOOT0_BINLOG, the levels above CFG_LOG_LEVEL_UART go to the binary log
+ * instead of the console, so CFG_LOG_LEVEL=4 records pr_debug() there.
+ */
+#define LOG_ERR		1
+#define LOG_WARN	2
+#define LOG_INFO	3
+#define LOG_DEBUG	4
+
+#ifndef CFG_LOG_LEVEL
+#define CFG_LOG_LEVEL	LOG_INFO
+#endif
+
+#ifndef CFG_LOG_LEVEL_UART
+#define CFG_LOG_LEVEL_UART	LOG_INFO
+#endif
+
+#define boot_log(level, fmt, args...)				\
+	do {							\
+		if ((level) > CFG_LOG_LEVEL)			\
+			break;					\
+		if ((level) <= CFG_LOG_LEVEL_UART)		\
+			printf(fmt, ##args);			\
+		else						\
+			blog_printf(fmt, ##args);		\
+	} while (0)
+#define pr_err(fmt, args...)	boot_log(LOG_ERR, fmt, ##args)
+#define pr_warn(fmt, args...)	boot_log(LOG_WARN, fmt, ##args)
+#define pr_info(fmt, args...)	boot_log(LOG_INFO, fmt, ##args)
+#define pr_debug(fmt, args...)	boot_log(LOG_DEBUG, fmt, ##args)
+
 void ndump(u8 *buf, int count);
 void __assert_fail(const char *assertion, const char *file, unsigned line,
 		   const char *function);
@@ -105,6 +175,9 @@ void* memset(void *s, int c, size_t count);
 void* memcpy0(void *dest, const void *src, size_t n);
 void* memcpy(void *dest, const void *src, size_t count);
 void* memmove(void *dest, const void *src, size_t count);
+#if defined(CFG_SUNXI_MEMOP) || defined(CFG_ARCH_RISCV)
+#define __HAVE_ARCH_MEMMOVE	/* lz4.c has its own otherwise */
+#endif
 int memcmp(const void *cs,const void *ct,size_t count);
 void* memscan(void *addr, int c, size_t size);
 char* strstr(const char *s1,const char *s2);
@@ -114,6 +187,8 @@ int malloc_init(u32 start, u32 size);
 void* malloc(u32 size);
 void* realloc(void *p, u32 size);
 void  free(void *p);
+ulong malloc_mark(void);
+void  malloc_release(ulong mark);
 
 
 
@@ -122,7 +197,20 @@ int load_image(phys_addr_t *uboot_base, phys_addr_t *optee_base, \
 				phys_addr_t *monitor_base, phys_addr_t *rtos_base, \
 				phys_addr_t *opensbi_base, phys_addr_t *dtb_base);
 void update_flash_para(phys_addr_t uboot_base);
+int load_toc1_direct(int (*read_sum)(u32 sector, void *dst, uint size, u32 *sum));
+u32 toc1_sum_update(u32 sum, const void *buf, u32 size);
+int load_toc1_staged(void);
+u32 memcpy_addsum(void *dst, const void *src, u32 size, u32 sum);
 int verify_addsum(void *mem_base, u32 size);
+u32 add_sum_update(u32 sum, const void *buf, u32 size);
+#ifdef CFG_SUNXI_DMA_MEMCPY
+int dma_memcpy(void *dst, const void *src, u32 len);
+void dma_memcpy_wait(void);
+#else
+/* the caller copies on the CPU */
+static inline int dma_memcpy(void *dst, const void *src, u32 len) { return -1; }
+static inline void dma_memcpy_wait(void) {}
+#endif
 u32 g_mod( u32 dividend, u32 divisor, u32 *quot_p);
 char get_uart_input(void);
 
@@ -136,6 +224,12 @@ uint8_t sunxi_board_late_init(void);
 void pattern_end(uint32_t pass);
 
 int gunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp);
+#if defined(CFG_SUNXI_GUNZIP) || defined(CFG_EXT2_LOADER)
+void crc32_init(void);
+#else
+static inline void crc32_init(void) {}
+#endif
+uint32_t crc32(uint32_t crc, const uint8_t *buf, uint len);
 
 void neon_enable(void);
 
@@ -26,14 +26,31 @@
 #define CONFIG_SYS_SRAMC_BASE            (0x28000)
 #define CONFIG_SYS_SRAMC_SIZE            (128 << 10)
 
+/* c906 core local interruptor, machine timer compare */
+#define SUNXI_CLINT_BASE                 (0x14000000)
+#define SUNXI_CLINT_MTIMECMPL            (SUNXI_CLINT_BASE + 0x4000)
+#define SUNXI_CLINT_MTIMECMPH            (SUNXI_CLINT_BASE + 0x4004)
+
 /* dram layout*/
 #define SDRAM_OFFSET(x)                   ((phys_addr_t)0x40000000 + (x))
 #define CONFIG_SYS_DRAM_BASE              SDRAM_OFFSET(0)
 #define DRAM_PARA_STORE_ADDR              SDRAM_OFFSET(0x00800000) /*fel*/      /*same as base.h*/
-#define CONFIG_HEAP_BASE                  SDRAM_OFFSET(0x00800000) /*secure */ /*same as base.h*/
-#define CONFIG_HEAP_SIZE                  (16 * 1024 * 1024)  /*same as base.h*/
 
 #define CONFIG_BOOTPKG_BASE               SDRAM_OFFSET(0x01000000) /*same as base.h*/
+#define CONFIG_BOOTPKG_MAX_SIZE           (CONFIG_BOOT0_WORK_BASE - CONFIG_BOOTPKG_BASE) /*up to the work area*/
+/* boot0 work area, past the FDT at 0x44000000 and the 1M it may grow to; no image is loaded here */
+#define CONFIG_BOOT0_WORK_BASE            SDRAM_OFFSET(0x04100000) /*ext2load scratch*/
+#define CONFIG_BOOT0_WORK_SIZE            (0x00300000)
+#define CONFIG_MMC_DES_BASE               SDRAM_OFFSET(0x04280000) /*mmc IDMAC ring, 32K*/
+#define CONFIG_MMC_TUNING_BASE            SDRAM_OFFSET(0x04290000) /*mmc sample delay sweep, 16K*/
+#define CONFIG_HEAP_BASE                  SDRAM_OFFSET(0x042a0000) /*up to the end of the work area*/
+#define CONFIG_HEAP_SIZE                  (0x00160000)
+#define CONFIG_BOOT0_BLOG_BASE            SDRAM_OFFSET(0x001c0000) /*binary log, up to the log*/
+#define CONFIG_BOOT0_BLOG_SIZE            (0x20000)
+#define CONFIG_BOOT0_LOG_BASE             SDRAM_OFFSET(0x001e0000) /*up to the timeline*/
+#define CONFIG_BOOT0_LOG_SIZE             (0x1f000)
+#define CONFIG_BOOT0_TIMELINE_BASE        SDRAM_OFFSET(0x001ff000) /*below the kernel at 0x40200000*/
+#define CONFIG_BOOT0_TIMELINE_SIZE        (0x1000)
 
 #define SUNXI_DRAM_PARA_MAX               32
 
@@ -49,6 +66,10 @@
 #define FEL_BASE                          0x20
 #define SECURE_FEL_BASE                  (0x20)
 #define CONFIG_BOOT0_RUN_ADDR            (0x20000)  /* sram a */
+#define CONFIG_BOOT0_PROFILE_BASE        (CONFIG_BOOT0_RUN_ADDR + CFG_SYS_INIT_RAM_SIZE) /* sram c, below the stack */
+#ifndef CFG_BOOT0_PROFILE_HZ
+#define CFG_BOOT0_PROFILE_HZ             1000
+#endif
 #define CONFIG_NBOOT_STACK               (CONFIG_SYS_SRAMC_BASE+CONFIG_SYS_SRAMC_SIZE)
 #define CONFIG_TOC0_RUN_ADDR             (0x20480)  /* sram a */
 #define CONFIG_HASH_TABLE_STACK_GAP      (4)
@@ -0,0 +1,53 @@
+/*
+ * SPDX-License-Identifier:	GPL-2.0+
+ *
+ * per scope hardware counters, built with CFG_BOOT0_PMU
+ *
+ *	PMU_SCOPE(scope, "name");
+ *	pmu_begin(&scope);
+ *	...
+ *	pmu_end(&scope);
+ *
+ * adds what the counters moved by between the two to the scope, and
+ * pmu_report() prints every scope that was ended at least once.
+ */
+
+#ifndef _PMU_H_
+#define _PMU_H_
+
+#include <linux/types.h>
+
+enum pmu_counter {
+	PMU_CYCLES,
+	PMU_INSTRET,
+	PMU_L1I_MISS,
+	PMU_L1D_READ_MISS,
+	PMU_L1D_WRITE_MISS,
+	PMU_NR,
+};
+
+struct pmu_scope {
+	const char *name;
+	struct pmu_scope *next;	/* reported scopes, once ended */
+	u32 calls;
+	u64 start[PMU_NR];
+	u64 sum[PMU_NR];
+};
+
+#ifdef CFG_BOOT0_PMU
+#define PMU_SCOPE(var, str)	static struct pmu_scope var = { .name = str }
+
+void pmu_init(void);
+void pmu_read(u64 *count);
+void pmu_begin(struct pmu_scope *scope);
+void pmu_end(struct pmu_scope *scope);
+void pmu_report(void);
+#else
+#define PMU_SCOPE(var, str)
+#define pmu_init()		do { } while (0)
+#define pmu_begin(scope)	do { } while (0)
+#define pmu_end(scope)		do { } while (0)
+#define pmu_report()		do { } while (0)
+#endif
+
+#endif
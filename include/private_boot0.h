@@ -91,6 +91,53 @@ typedef struct _sboot_file_head_t
 #endif
 }sboot_file_head_t;
 
+/******************************************************************************/
+/*               boot timeline, at CONFIG_BOOT0_TIMELINE_BASE                 */
+/******************************************************************************/
+#define BOOT0_TIMELINE_MAGIC            0x4c543042   /* "B0TL" */
+#define BOOT0_TIMELINE_MAX              32
+#define BOOT0_TIMELINE_FREQ             24000000     /* arch counter, Hz */
+
+struct boot0_timeline_entry {
+	__u64  stamp;              /* arch counter at the end of the phase */
+	char   name[16];           /* phase, NUL-terminated */
+};
+
+struct boot0_timeline {
+	__u32  magic;              /* BOOT0_TIMELINE_MAGIC */
+	__u32  count;              /* entries used */
+	__u32  freq;               /* BOOT0_TIMELINE_FREQ */
+	__u32  reserved;
+	struct boot0_timeline_entry entry[BOOT0_TIMELINE_MAX];
+};
+
+/******************************************************************************/
+/*                   console log, at CONFIG_BOOT0_LOG_BASE                    */
+/******************************************************************************/
+#define BOOT0_LOG_MAGIC                 0x474f4c42   /* "BLOG" */
+
+struct boot0_log {
+	__u32  magic;              /* BOOT0_LOG_MAGIC */
+	__u32  len;                /* bytes in buf */
+	__u32  size;               /* room in buf */
+	__u32  dropped;            /* bytes printed but not in buf */
+	char   buf[];              /* as sent to the UART, \r\n line ends */
+};
+
+/*
+ * binary log, a struct boot0_log at CONFIG_BOOT0_BLOG_BASE whose buf holds
+ * records: the header, then a u64 per argument of fmt as _vprintf() takes
+ * them, a %s as a u64 length and up to 64 of its bytes padded to 8.
+ * tools/boot0_blog.py turns it back into text with boot0.elf.
+ */
+#define BOOT0_BLOG_MAGIC                0x4e494242   /* "BBIN" */
+
+struct boot0_blog_rec {
+	__u32  fmt;                /* address of the format string */
+	__u32  size;               /* of the record, header included */
+	__u64  stamp;              /* arch counter */
+};
+
 extern const sboot_file_head_t  sboot_head ;
 extern const boot0_file_head_t BT0_head;
 extern const boot0_file_head_t fes1_head;
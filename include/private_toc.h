@@ -88,10 +88,18 @@ typedef struct sbrom_toc1_item_info
 	                       //if it is a certif file, it should equal to the bin file index
 	                       //that they are in the same group
 	                       //it should be 0 when it anyother data type
-	u32  reserved[69];	   //reserved for future;
+	u32  comp;             //TOC1_ITEM_COMP_*, run_addr gets the data decompressed
+	u32  raw_len;          //decompressed length of a compressed item
+	u8   sha256[32];       //sha256 of the data as stored, all 0 if none
+	u32  reserved[59];	   //reserved for future;
 	u32  end;
 }sbrom_toc1_item_info_t;
 
+#define TOC1_ITEM_COMP_NONE	0
+#define TOC1_ITEM_COMP_GZIP	1
+#define TOC1_ITEM_COMP_LZ4	2
+#define TOC1_ITEM_COMP_LZMA	3
+
 typedef struct sbrom_toc0_config
 {
 	unsigned char    	config_vsn[4];
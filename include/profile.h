@@ -0,0 +1,23 @@
+/*
+ * SPDX-License-Identifier:	GPL-2.0+
+ *
+ * sampling profiler, built with CFG_BOOT0_PROFILE: the machine timer
+ * interrupts boot0 CFG_BOOT0_PROFILE_HZ times a second and mepc is counted
+ * in a histogram of the boot0 text at CONFIG_BOOT0_PROFILE_BASE.
+ * profile_dump() prints it for tools/boot0_profile.py.
+ */
+
+#ifndef _PROFILE_H_
+#define _PROFILE_H_
+
+#ifdef CFG_BOOT0_PROFILE
+void profile_start(void);
+void profile_stop(void);
+void profile_dump(void);
+#else
+#define profile_start()		do { } while (0)
+#define profile_stop()		do { } while (0)
+#define profile_dump()		do { } while (0)
+#endif
+
+#endif
@@ -19,7 +19,12 @@ OBJDUMP		= $(CROSS_COMPILE)objdump
 
 ##########################################################
 ifeq (x$(CPU), xriscv64)
+ifeq ($(CFG_RISCV_XTHEAD),y)
+# c906 scalar extensions, see asm/xthead.h, gcc 13 and binutils 2.40 know them
+MARCH := rv64gc_xtheadba_xtheadbb_xtheadcondmov_xtheadmemidx
+else
 MARCH := rv64gc
+endif
 MABI := lp64
 
 SPLINCLUDE    := \
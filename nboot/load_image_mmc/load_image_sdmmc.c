@@ -67,6 +67,50 @@ void update_flash_para(phys_addr_t uboot_base)
 }
 
 
+#ifdef CFG_TOC1_DIRECT_LOAD
+/* the package is read in chunks of this many sectors */
+#define TOC1_CHUNK_SECTORS	2048
+
+/*
+ * read size bytes from sector on into dst, adding them to *sum: each chunk is
+ * summed while the next one is in flight
+ */
+static int load_toc1_rest(int card_no, int sector, u8 *dst, uint size, u32 *sum)
+{
+	u8 *prev = NULL;
+	uint prev_len = 0;
+	uint left = (size + 511) / 512;
+	unsigned long n;
+
+	while (left)
+	{
+		n = mmc_bread_async(card_no, sector, left > TOC1_CHUNK_SECTORS ? TOC1_CHUNK_SECTORS : left, dst);
+		if (!n)
+			return -1;
+		if (prev_len)
+			*sum = toc1_sum_update(*sum, prev, prev_len);
+		if (mmc_wait(card_no) != n)
+			return -1;
+		prev = dst;
+		prev_len = (n * 512 > size) ? size : n * 512;
+		size -= prev_len;
+		dst += n * 512;
+		sector += n;
+		left -= n;
+	}
+	*sum = toc1_sum_update(*sum, prev, prev_len);
+
+	return 0;
+}
+
+static int toc1_card_no, toc1_start_sector;
+
+static int toc1_sdmmc_read_sum(u32 sector, void *dst, uint size, u32 *sum)
+{
+	return load_toc1_rest(toc1_card_no, toc1_start_sector + sector, dst, size, sum);
+}
+#endif
+
 int load_toc1_from_sdmmc(char *buf)
 {
 	u8  *tmp_buff = (u8 *)CONFIG_BOOTPKG_BASE;
@@ -82,7 +126,7 @@ int load_toc1_from_sdmmc(char *buf)
 
 	card_no = get_card_num();
 
-	printf("card no is %d\n", card_no);
+	pr_debug("card no is %d\n", card_no);
 	if(card_no < 0)
 	{
 		error_num = E_SDMMC_NUM_ERR;
@@ -93,13 +137,14 @@ int load_toc1_from_sdmmc(char *buf)
 	{
 		sdcard_info->line_sel[card_no] = 4;
 	}
-	printf("sdcard %d line count %d\n", card_no, sdcard_info->line_sel[card_no] );
+	pr_debug("sdcard %d line count %d\n", card_no, sdcard_info->line_sel[card_no] );
 
 	if( sunxi_mmc_init(card_no, sdcard_info->line_sel[card_no], BT0_head.prvt_head.storage_gpio, 16) == -1) 
 	{
 		error_num = E_SDMMC_INIT_ERR;
 		goto __ERROR_EXIT;;
 	}
+	timeline_mark("mmc");
 
 	for(i=0; i < 4; i++)
 	{
@@ -110,6 +155,16 @@ int load_toc1_from_sdmmc(char *buf)
 			error_num = E_SDMMC_FIND_BOOT1_ERR;
 			goto __ERROR_EXIT;
 		}
+#ifdef CFG_TOC1_DIRECT_LOAD
+		toc1_card_no = card_no;
+		toc1_start_sector = start_sector;
+		ret = load_toc1_direct(toc1_sdmmc_read_sum);
+		if(ret == 0)
+			break;
+		else if(ret < 0)
+			continue;
+		/* items can't be placed directly, read the package whole */
+#endif
 		ret = mmc_bread(card_no, start_sector, 64, tmp_buff);
 		if(!ret)
 		{
@@ -119,10 +174,15 @@ int load_toc1_from_sdmmc(char *buf)
 		toc1_head = (struct sbrom_toc1_head_info *)tmp_buff;
 		if(toc1_head->magic != TOC_MAIN_INFO_MAGIC)
 		{
-			printf("error:bad magic.\n");
+			pr_err("error:bad magic.\n");
 			continue;
 		}
 		total_size = toc1_head->valid_len;
+		if(total_size > CONFIG_BOOTPKG_MAX_SIZE)
+		{
+			pr_err("error:toc1 too large.\n");
+			continue;
+		}
 		if(total_size > 64 * 512)
 		{
 			tmp_buff += 64*512;
@@ -134,20 +194,18 @@ int load_toc1_from_sdmmc(char *buf)
 			}
 		}
 
-		if( verify_addsum( (__u32 *)CONFIG_BOOTPKG_BASE, total_size) != 0 )
-		{
-			printf("error:bad checksum.\n");
+		/* summed while the items are moved to their run_addr */
+		if(load_toc1_staged())
 			continue;
-		}
 		break;
 	}
-	printf("Loading boot-pkg Succeed(index=%d).\n",
+	pr_info("Loading boot-pkg Succeed(index=%d).\n",
 		(BT0_head.boot_head.platform[0] & 0xf0)>>4);
 	sunxi_mmc_exit( card_no, BT0_head.prvt_head.storage_gpio, 16 );
 	return 0;
 
 __ERROR_EXIT:
-	printf("Loading boot-pkg fail(error=%d)\n",error_num);
+	pr_err("Loading boot-pkg fail(error=%d)\n",error_num);
 	sunxi_mmc_exit(card_no, BT0_head.prvt_head.storage_gpio, 16 );
 	return -1;
 
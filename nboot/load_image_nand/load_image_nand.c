@@ -33,36 +33,41 @@ int load_toc1_from_rawnand( void )
 
 	if(NF_open( ) == NF_ERROR)
 	{
-		printf("fail in opening nand flash\n");
+		pr_err("fail in opening nand flash\n");
 		return -1;
 	}
 
-	printf("block from %d to %d\n", BOOT1_START_BLK_NUM, BOOT1_LAST_BLK_NUM);
+	pr_debug("block from %d to %d\n", BOOT1_START_BLK_NUM, BOOT1_LAST_BLK_NUM);
 	for( i = BOOT1_START_BLK_NUM;  i <= BOOT1_LAST_BLK_NUM;  i++ )
 	{
 		if( NF_read_status( i ) == NF_BAD_BLOCK )
 		{
-			printf("nand block %d is bad\n", i);
+			pr_warn("nand block %d is bad\n", i);
 			continue;
 		}
 		/*read head*/
 		if( NF_read( i * ( NF_BLOCK_SIZE >> NF_SCT_SZ_WIDTH ), (void *)buffer, 1 )  == NF_OVERTIME_ERR )
 		{
-			printf("the first data is error\n");
+			pr_err("the first data is error\n");
 			continue;
 		}
 		/* check magic */
 		toc1_head = (sbrom_toc1_head_info_t *) buffer;
 		if(toc1_head->magic != TOC_MAIN_INFO_MAGIC)
 		{
-			printf("%s err: the toc1 head magic is invalid\n", __func__);
+			pr_err("%s err: the toc1 head magic is invalid\n", __func__);
 			continue;
 		}
 		/* check align */
 		length =  toc1_head->valid_len;
 		if( ( length & ( ALIGN_SIZE - 1 ) ) != 0 )
 		{
-			printf("the boot1 is not aligned by 0x%x\n", ALIGN_SIZE);
+			pr_err("the boot1 is not aligned by 0x%x\n", ALIGN_SIZE);
+			continue;
+		}
+		if( length > CONFIG_BOOTPKG_MAX_SIZE )
+		{
+			pr_err("the boot1 is larger than 0x%x\n", (u32)CONFIG_BOOTPKG_MAX_SIZE);
 			continue;
 		}
 		if( 1==load_uboot_in_one_block_judge(length) )
@@ -75,7 +80,7 @@ int load_toc1_from_rawnand( void )
 			}
 			else if( status == ADV_NF_OK )
 			{
-				printf("Check is correct.\n");
+				pr_debug("Check is correct.\n");
 				NF_close( );
 				return 0;
 			}
@@ -88,25 +93,25 @@ int load_toc1_from_rawnand( void )
 			                          NF_BLOCK_SIZE, &read_blks );
 			if( status == ADV_NF_LACK_BLKS )
 			{
-				printf("ADV_NF_LACK_BLKS\n");
+				pr_warn("ADV_NF_LACK_BLKS\n");
 				NF_close( );
 				return -1;
 			}
 			else if( status == ADV_NF_OVERTIME_ERR )
 			{
-				printf("mult block ADV_NF_OVERTIME_ERR\n");
+				pr_warn("mult block ADV_NF_OVERTIME_ERR\n");
 				continue;
 			}
-			if( verify_addsum( (__u32 *)buffer, length ) == 0 )
+			if( load_toc1_staged() == 0 )
 			{
-				printf("The file stored in start block %u is perfect.\n", i );
+				pr_debug("The file stored in start block %u is perfect.\n", i );
 				NF_close( );
 				return 0;
 			}
 		}
 	}
 
-	printf("Can't find a good Boot1 copy in nand.\n");
+	pr_err("Can't find a good Boot1 copy in nand.\n");
 	NF_close( );
 	return -1;
 }
@@ -124,27 +129,27 @@ __s32 load_toc1_from_spinand( void )
 
 	if(SpiNand_PhyInit( ) != 0)
 	{
-		printf("fail in opening nand flash\n");
+		pr_err("fail in opening nand flash\n");
 		return -1;
 	}
 
-	printf("block from %d to %d\n", UBOOT_START_BLK_NUM, UBOOT_LAST_BLK_NUM);
+	pr_debug("block from %d to %d\n", UBOOT_START_BLK_NUM, UBOOT_LAST_BLK_NUM);
 	for( i = UBOOT_START_BLK_NUM;  i <= UBOOT_LAST_BLK_NUM;  i++ )
 	{
 		if( SpiNand_Check_BadBlock( i ) == SPINAND_BAD_BLOCK )
 		{
-			printf("spi nand block %d is bad\n", i);
+			pr_warn("spi nand block %d is bad\n", i);
 		    continue;
 		}
 		if( SpiNand_Read( i * ( SPN_BLOCK_SIZE >> NF_SCT_SZ_WIDTH ), (void *)buffer, 1 )  == NAND_OP_FALSE )
 		{
-		    printf("the first data is error\n");
+		    pr_err("the first data is error\n");
 			continue;
 		}
 		toc1_head = (sbrom_toc1_head_info_t *) buffer;
 		if(toc1_head->magic != TOC_MAIN_INFO_MAGIC)
 		{
-				printf("%s err:  magic is invalid\n", __func__);
+				pr_err("%s err:  magic is invalid\n", __func__);
 				continue;
 		}
 
@@ -152,25 +157,30 @@ __s32 load_toc1_from_spinand( void )
 		length =  toc1_head->valid_len;
 		if( ( length & ( ALIGN_SIZE - 1 ) ) != 0 )
 		{
-			printf("the boot1 is not aligned by 0x%x\n", ALIGN_SIZE);
+			pr_err("the boot1 is not aligned by 0x%x\n", ALIGN_SIZE);
+			continue;
+		}
+		if( length > CONFIG_BOOTPKG_MAX_SIZE )
+		{
+			pr_err("the boot1 is larger than 0x%x\n", (u32)CONFIG_BOOTPKG_MAX_SIZE);
 			continue;
 		}
 
 		status = Spinand_Load_Boot1_Copy( i, (void*)buffer, length, SPN_BLOCK_SIZE, &read_blks );
 		if( status == NAND_OP_FALSE )
 		{
-			printf("SPI nand load uboot copy fail\n");
+			pr_err("SPI nand load uboot copy fail\n");
 			continue;
 		}
-		if( verify_addsum( buffer, length ) == 0 )
+		if( load_toc1_staged() == 0 )
 		{
-			printf("Check is correct.\n");
+			pr_debug("Check is correct.\n");
 		    SpiNand_PhyExit( );
 		    return 0;
 		}
 	}
 
-	printf("Can't find a good Boot1 copy in spi nand.\n");
+	pr_err("Can't find a good Boot1 copy in spi nand.\n");
 	SpiNand_PhyExit( );
 	return -1;
 }
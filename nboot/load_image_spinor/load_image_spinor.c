@@ -36,41 +36,88 @@ void update_flash_para(phys_addr_t uboot_base)
 }
 
 
+#ifdef CFG_TOC1_DIRECT_LOAD
+/* the package is read in chunks of this many sectors, summed while still in the cache */
+#define TOC1_CHUNK_SECTORS	64
+
+static int toc1_spinor_read_sum(u32 sector, void *buf, uint size, u32 *sum)
+{
+	u8 *dst = buf;
+	uint n, len;
+
+	while(size)
+	{
+		n = min((size + 511) / 512, (uint)TOC1_CHUNK_SECTORS);
+		len = min(size, n * 512);
+		if(spinor_read(CFG_SPINOR_UBOOT_OFFSET + sector, n, dst))
+			return -1;
+		*sum = toc1_sum_update(*sum, dst, len);
+		sector += n;
+		dst += n * 512;
+		size -= len;
+	}
+
+	return 0;
+}
+#endif
+
 int load_toc1_from_spinor(void *storage_data)
 {
 	sbrom_toc1_head_info_t	*toc1_head;
 	u8  *tmp_buff = (u8 *)CONFIG_BOOTPKG_BASE;
 	int start_sector = CFG_SPINOR_UBOOT_OFFSET;
 	uint total_size = 0;
+#ifdef CFG_TOC1_DIRECT_LOAD
+	int ret;
+#endif
 
 	if(spinor_init(0))
 	{
-		printf("spinor init fail\n");
+		pr_err("spinor init fail\n");
 		return -1;
 	}
+	timeline_mark("spinor");
+
+#ifdef CFG_TOC1_DIRECT_LOAD
+	ret = load_toc1_direct(toc1_spinor_read_sum);
+	if(ret == 0)
+		return 0;
+	/* items can't be placed directly or the read failed, read the package whole */
+	if(ret < 0)
+		pr_warn("toc1 direct load failed, reading it whole\n");
+#endif
 
 	if(spinor_read(start_sector, 1, (void *)tmp_buff ) )
 	{
-		printf("the first data is error\n");
+		pr_err("the first data is error\n");
 		goto __load_boot1_from_spinor_fail;
 	}
-	printf("Succeed in reading toc file head.\n");
+	pr_debug("Succeed in reading toc file head.\n");
 
 	toc1_head = (struct sbrom_toc1_head_info *)tmp_buff;
 	if(toc1_head->magic != TOC_MAIN_INFO_MAGIC)
 	{
-		printf("toc1 magic error\n");
+		pr_err("toc1 magic error\n");
 		goto __load_boot1_from_spinor_fail;
 	}
 	total_size = toc1_head->valid_len;
-	printf("The size of toc is %x.\n", total_size );
+	pr_debug("The size of toc is %x.\n", total_size );
+	if(total_size > CONFIG_BOOTPKG_MAX_SIZE)
+	{
+		pr_err("toc1 too large\n");
+		goto __load_boot1_from_spinor_fail;
+	}
 
 	if(spinor_read(start_sector, total_size/512, (void *)tmp_buff ))
 	{
-		printf("spinor read data error\n");
+		pr_err("spinor read data error\n");
 		goto __load_boot1_from_spinor_fail;
 	}
 
+	/* summed while the items are moved to their run_addr */
+	if(load_toc1_staged())
+		goto __load_boot1_from_spinor_fail;
+
 	return 0;
 
 __load_boot1_from_spinor_fail:
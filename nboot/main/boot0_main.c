@@ -6,6 +6,8 @@
 
 #include <common.h>
 #include <libfdt.h>
+#include <pmu.h>
+#include <profile.h>
 #include <private_boot0.h>
 #include <private_uboot.h>
 #include <private_toc.h>
@@ -22,19 +24,26 @@ static int boot0_clear_env(void);
 
 void main(void)
 {
+	PMU_SCOPE(dram_scope, "init_DRAM");
 	int dram_size;
 	int status;
 	phys_addr_t  uboot_base = 0, optee_base = 0, monitor_base = 0, \
 				rtos_base = 0, opensbi_base = 0, dtb_base = 0;
 
+	timeline_mark("boot0");
+	vector_init();
+	pmu_init();
 	sunxi_serial_init(BT0_head.prvt_head.uart_port, (void *)BT0_head.prvt_head.uart_ctrl, 6);
+	timeline_mark("serial");
+	profile_start();
 	printf("HELLO! BOOT0 is starting!\n");
-	printf("BOOT0 commit : %s\n", BT0_head.hash);
+	pr_info("BOOT0 commit : %s\n", BT0_head.hash);
 	sunxi_set_printf_debug_mode(BT0_head.prvt_head.debug_mode);
 
 	status = sunxi_board_init();
 	if(status)
 		goto _BOOT_ERROR;
+	timeline_mark("board_init");
 
 	if (rtc_probe_fel_flag()) {
 		rtc_clear_fel_flag();
@@ -44,7 +53,7 @@ void main(void)
 		goto _BOOT_ERROR;
 #endif
 	} else if (BT0_head.prvt_head.enable_jtag) {
-		printf("enable_jtag\n");
+		pr_info("enable_jtag\n");
 		boot_set_gpio((normal_gpio_cfg *)BT0_head.prvt_head.jtag_gpio, 5, 1);
 	}
 
@@ -55,36 +64,43 @@ void main(void)
 	if (BT0_head.prvt_head.dram_para[30] & (1 << 11))
 		neon_enable();
 #endif
+	pmu_begin(&dram_scope);
 	dram_size = init_DRAM(0, (void *)BT0_head.prvt_head.dram_para);
+	pmu_end(&dram_scope);
 #endif
 	if(!dram_size)
 		goto _BOOT_ERROR;
 	else {
-		printf("dram size =%d\n", dram_size);
+		pr_info("dram size =%d\n", dram_size);
 	}
+	console_log_init((void *)CONFIG_BOOT0_LOG_BASE, CONFIG_BOOT0_LOG_SIZE);
+	blog_init((void *)CONFIG_BOOT0_BLOG_BASE, CONFIG_BOOT0_BLOG_SIZE);
+	timeline_mark("dram");
 
 	char uart_input_value = get_uart_input();
 
 	if (uart_input_value == '2') {
 		sunxi_set_printf_debug_mode(3);
-		printf("detected user input 2\n");
+		pr_info("detected user input 2\n");
 		goto _BOOT_ERROR;
 	} else if (uart_input_value == 'd') {
 		sunxi_set_printf_debug_mode(8);
-		printf("detected user input d\n");
+		pr_info("detected user input d\n");
 	}
 
 	mmu_enable(dram_size);
-	//malloc_init(CONFIG_HEAP_BASE, CONFIG_HEAP_SIZE);
+	malloc_init(CONFIG_HEAP_BASE, CONFIG_HEAP_SIZE);
+	crc32_init();
 	status = sunxi_board_late_init();
 	if (status)
 		goto _BOOT_ERROR;
 
 #ifndef CFG_EXT2_LOADER
 	status = load_package();
+	timeline_mark("package");
 	if(status == 0 )
-		load_image(&uboot_base, &optee_base, &monitor_base, &rtos_base, &opensbi_base, &dtb_base);
-	else
+		status = load_image(&uboot_base, &optee_base, &monitor_base, &rtos_base, &opensbi_base, &dtb_base);
+	if(status != 0)
 		goto _BOOT_ERROR;
 #else
 	char *append_cmdline;
@@ -99,7 +115,7 @@ void main(void)
 		uint32_t reg[4];
 		int offs;
 
-		printf("Adding DRAM info to DTB.\n");
+		pr_debug("Adding DRAM info to DTB.\n");
 		status = fdt_open_into(fdt, fdt, SZ_1M);
 		if (status)
 			goto _BOOT_ERROR;
@@ -119,13 +135,33 @@ void main(void)
 			goto _BOOT_ERROR;
 		if (fdt_setprop(fdt, offs, "reg", reg, i * sizeof(*reg)) < 0)
 			goto _BOOT_ERROR;
+#ifdef CFG_EXT2_LOADER
+		if (append_cmdline) {
+			pr_debug("Setting bootargs.\n");
+			offs = fdt_path_offset(fdt, "/chosen");
+			if (offs < 0)
+				offs = fdt_add_subnode(fdt, 0, "chosen");
+			if (offs < 0)
+				goto _BOOT_ERROR;
+			if (fdt_setprop_string(fdt, offs, "bootargs", append_cmdline) < 0)
+				goto _BOOT_ERROR;
+		}
+#endif
+		timeline_mark("fdt");
+		timeline_fdt(fdt);
 		if (fdt_pack(fdt) < 0)
 			goto _BOOT_ERROR;
 	}
 
 	mmu_disable( );
 
-	printf("Jump to second Boot.\n");
+	profile_stop();
+	if (uart_input_value == 'p')
+		profile_dump();
+	pmu_report();
+	pr_info("Jump to second Boot.\n");
+	console_flush();
+	timeline_publish((void *)dtb_base);
 	if (opensbi_base) {
 			boot0_jmp_opensbi(opensbi_base, dtb_base, uboot_base);
 	} else if (monitor_base) {
@@ -137,7 +173,8 @@ void main(void)
 	} else if (optee_base)
 		boot0_jmp_optee(optee_base, uboot_base);
 	else if (rtos_base) {
-		printf("jump to rtos\n");
+		pr_info("jump to rtos\n");
+		console_flush();
 		boot0_jmp(rtos_base);
 	}
 	else
@@ -152,6 +189,8 @@ _BOOT_ERROR:
 
 static int boot0_clear_env(void)
 {
+	profile_stop();
+	console_flush();
 	sunxi_board_exit();
 	sunxi_board_clock_reset();
 	mmu_disable();
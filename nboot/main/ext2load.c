@@ -19,19 +19,61 @@
 /* references for ext2fs : 
  * https://www.kernel.org/doc/html/latest/filesystems/ext4/globals.html
  * https://www.kernel.org/doc/html/latest/filesystems/ext4/dynamic.html
+ * https://www.kernel.org/doc/html/latest/filesystems/ext4/ifork.html (extent tree)
  */
 
 #include <common.h>
+#include <pmu.h>
 #include <private_boot0.h>
 #include <spare_head.h>
 #include <mmc_boot0.h>
+#include <linux/sizes.h>
+#ifdef CFG_SUNXI_LZ4
+#include <u-boot/lz4.h>
+#endif
+#ifdef CFG_SUNXI_LZMA
+#include <lzma/LzmaTools.h>
+#endif
+#ifdef CFG_SUNXI_SHA256
+#include <u-boot/sha256.h>
+#endif
 extern const boot0_file_head_t  BT0_head;
 
 #define SDC_NO 0   /* number of SD Card */
-#define BGT_SIZE 1024 /* maximal size of block group descriptor table (in bytes) */
+#define MAX_BLOCK_SIZE 8 /* largest supported block size (in sectors), ie. 4096 bytes */
 
 #define INAT(type, ptr, offset) *((type *)(ptr+offset))
 
+/* incompatible features we know how to read; the high halves of 64bit fields are ignored, */
+/* which is fine as sector numbers are 32 bits anyway */
+#define EXT4_FEATURE_INCOMPAT_FILETYPE 0x0002
+#define EXT4_FEATURE_INCOMPAT_RECOVER  0x0004 /* journal needs recovery: we read the fs as is */
+#define EXT4_FEATURE_INCOMPAT_EXTENTS  0x0040
+#define EXT4_FEATURE_INCOMPAT_64BIT    0x0080
+#define EXT4_FEATURE_INCOMPAT_MMP      0x0100
+#define EXT4_FEATURE_INCOMPAT_FLEX_BG  0x0200
+#define EXT4_FEATURE_INCOMPAT_CSUM_SEED 0x2000
+#define EXT4_FEATURE_INCOMPAT_LARGEDIR 0x4000
+#define EXT4_FEATURE_INCOMPAT_SUPP (EXT4_FEATURE_INCOMPAT_FILETYPE|EXT4_FEATURE_INCOMPAT_RECOVER| \
+		EXT4_FEATURE_INCOMPAT_EXTENTS|EXT4_FEATURE_INCOMPAT_64BIT|EXT4_FEATURE_INCOMPAT_MMP| \
+		EXT4_FEATURE_INCOMPAT_FLEX_BG|EXT4_FEATURE_INCOMPAT_CSUM_SEED|EXT4_FEATURE_INCOMPAT_LARGEDIR)
+
+#define EXT4_EXTENTS_FL 0x80000 /* inode flag: i_block holds an extent tree */
+#define EXT4_EXT_MAGIC 0xF30A
+#define EXT4_EXT_MAX_DEPTH 2 /* one scratch block per level below the inode */
+
+#define EXT4_FEATURE_COMPAT_DIR_INDEX 0x0020
+#define EXT2_INDEX_FL 0x1000 /* inode flag: directory is a hashed (htree) index */
+#define EXT2_FLAGS_UNSIGNED_HASH 0x0002
+#define DX_HASH_LEGACY 0
+#define DX_HASH_HALF_MD4 1
+#define DX_HASH_TEA 2
+#define DX_HASH_LEGACY_UNSIGNED 3
+#define DX_HASH_HALF_MD4_UNSIGNED 4
+#define DX_HASH_TEA_UNSIGNED 5
+
+#define DIR_MAX_SIZE 0x100000 /* largest directory read by a linear lookup, in bytes */
+
 struct ext2_sb {
 	uint32_t part_offset; /* in sectors (1 sector=512 bytes) */
 	uint16_t block_size; /* in sectors */
@@ -39,14 +81,20 @@ struct ext2_sb {
 	uint32_t inodes_per_group;
 	uint32_t blocks_count;
 	uint32_t blocks_per_group;
-//	char bg_table[BGT_SIZE]; /* block group descriptor table */
+	uint32_t first_data_block; /* block holding the superblock: 1 for 1024-byte blocks, 0 otherwise */
+	uint16_t desc_size; /* size of a block group descriptor, in bytes */
+	uint32_t max_run; /* in sectors, largest read issued by a single mmc_bread() */
+	uint8_t dir_index; /* htree directories may be used */
+	uint8_t hash_unsigned; /* 3 if directory hashes use unsigned chars, 0 otherwise */
+	uint8_t dx_max_levels; /* maximal number of htree index levels below the root */
+	uint32_t hash_seed[4];
 };
 
 int ext2_sb_read(char *mbr, int part_num, char *buf, struct ext2_sb *sb) {
 	/* find beginning of partition */
 	char *part_entry=mbr+446+16*part_num;
 	if(!(part_entry[0] & 0x80)) {
-		printf("Partition %d : not bootable in MBR partition table\n", part_num);
+		pr_debug("Partition %d : not bootable in MBR partition table\n", part_num);
 		return(-1);
 	}
 	sb->part_offset=INAT(uint32_t, part_entry, 8); 
@@ -54,25 +102,41 @@ int ext2_sb_read(char *mbr, int part_num, char *buf, struct ext2_sb *sb) {
 	/* read ext2 superblock : 2 sectors (1024 bytes) at offset part_offset+2 sectors */
 	mmc_bread(SDC_NO, sb->part_offset+2, 2, buf);
 	if(buf[0x38]!=0x53 || buf[0x39]!=0xEF) {
-		printf("Partition %d : invalid ext2 magic number\n", part_num);
+		pr_warn("Partition %d : invalid ext2 magic number\n", part_num);
 		return(-1);
 	}
 	uint32_t feat_incompat=INAT(uint32_t, buf, 0x60); 
-	if(feat_incompat) {
-		printf("Partition %d : incompatible ext2/3/4 features (%x)\n", part_num, feat_incompat);
+	if(feat_incompat & ~EXT4_FEATURE_INCOMPAT_SUPP) {
+		pr_warn("Partition %d : incompatible ext2/3/4 features (%x)\n", part_num, feat_incompat & ~EXT4_FEATURE_INCOMPAT_SUPP);
 		return(-1);
 	}
+	if(feat_incompat & EXT4_FEATURE_INCOMPAT_RECOVER) {
+		pr_warn("Partition %d : warning, journal needs recovery\n", part_num);
+	}
 	uint32_t log_blksz=INAT(uint32_t, buf, 0x18); 
+	if(log_blksz>2) {
+		pr_warn("Partition %d : block size (%d) larger than %d\n", part_num, 1024 << log_blksz, MAX_BLOCK_SIZE*512);
+		return(-1);
+	}
 	sb->block_size=(1 << (1+log_blksz));
-	if(sb->block_size>2) {
-		printf("Partition %d : block size (%d) larger than 1024\n", part_num, sb->block_size*512);
+	/* revision 0 filesystems have fixed 128-byte inodes */
+	sb->inode_size=(INAT(uint32_t, buf, 0x4c) ? INAT(uint16_t, buf, 0x58) : 128);
+	sb->first_data_block=INAT(uint32_t, buf, 0x14);
+	sb->desc_size=((feat_incompat & EXT4_FEATURE_INCOMPAT_64BIT) ? INAT(uint16_t, buf, 0xfe) : 32);
+	if(sb->desc_size<32 || 512%sb->desc_size) {
+		pr_warn("Partition %d : unsupported block group descriptor size (%d)\n", part_num, sb->desc_size);
 		return(-1);
 	}
-	sb->inode_size=INAT(uint16_t, buf, 0x58); 
 	sb->inodes_per_group=INAT(uint32_t, buf, 0x28); 
 	sb->blocks_count=INAT(uint32_t, buf, 0x4); 
 	sb->blocks_per_group=INAT(uint32_t, buf, 0x20); 
-	printf("Partition %d : ext2, %d blocks, block size %d, inode size %d, %d inodes per group, %d blocks per group\n", 
+	sb->dir_index=((INAT(uint32_t, buf, 0x5c) & EXT4_FEATURE_COMPAT_DIR_INDEX) != 0);
+	sb->hash_unsigned=((INAT(uint32_t, buf, 0x160) & EXT2_FLAGS_UNSIGNED_HASH) ? 3 : 0);
+	sb->dx_max_levels=((feat_incompat & EXT4_FEATURE_INCOMPAT_LARGEDIR) ? 2 : 1);
+	memcpy((char*)sb->hash_seed, buf+0xec, 16);
+	sb->max_run=mmc_bread_max(SDC_NO);
+	if(sb->max_run<sb->block_size) sb->max_run=sb->block_size;
+	pr_debug("Partition %d : ext2, %d blocks, block size %d, inode size %d, %d inodes per group, %d blocks per group\n", 
 			part_num, sb->blocks_count, sb->block_size*512, sb->inode_size, sb->inodes_per_group, sb->blocks_per_group);
 
 	return(0);
@@ -81,185 +145,387 @@ int ext2_sb_read(char *mbr, int part_num, char *buf, struct ext2_sb *sb) {
 int ext2_read_block(struct ext2_sb *sb, uint32_t block_num, char *buf) {
 	//printf(" (read block %d part_off=%d block_size=%d)\n", block_num, sb->part_offset, sb->block_size);
 	int rc;
-	if((rc=mmc_bread(SDC_NO, sb->part_offset+block_num*sb->block_size, sb->block_size, buf))<0) {
-		printf("read block %d failed\n", block_num);
+	if((rc=mmc_bread(SDC_NO, sb->part_offset+block_num*sb->block_size, sb->block_size, buf))!=sb->block_size) {
+		pr_err("read block %d failed\n", block_num);
 		return(-1);
 	}
 	return(rc);
 }
 
-#if 0
-/* cache block group descriptor table into the sb struct */
-/* for memory reasons max block size=max BGTable size=1024B, so max block groups=1024/32=32 */
-/* with default blocks per group (8192) this gives a maximal FS size of 256MiB, */
-/* use the -g parameter of mke2fs if you want more */
-static void ext2_read_bgtable(struct ext2_sb *sb) {
-	/* figure out how many blocks are occupied by block group descriptor table */
-	uint32_t bg_count=(sb->blocks_count+sb->blocks_per_group-1)/sb->blocks_per_group;
-	uint32_t bgtable_size=32*bg_count; /* bgtable size in bytes, each block grp descriptor is 32B */
-	if(bgtable_size>BGT_SIZE) {
-		printf("Warning: block group descriptor table size (%d) is larger than %d, truncating\n", bgtable_size, BGT_SIZE);
-		bgtable_size=BGT_SIZE;
-	}
-	bgtable_size=1; //(bgtable_size+512*sb->block_size-1)/(512*sb->block_size); /* number of blocks for the bgtable */
-
-	/* if blocksize>1024B : superblock is at block 0+1024B, first block group descriptor in block 1+0B */
-	/* if blocksize==1024B: superblock is at block 1+0B, first block group descriptor in block 2+0B */
-	uint32_t bgtable_begin=2;   //(sb->block_size > 2 ? 1 : 2);
-
-	printf("%d block groups, block group descriptor table has %d block(s) starting from block %d\n", 
-			bg_count, bgtable_size, bgtable_begin);
-
-	for(uint32_t bl=0; bl<bgtable_size; bl++) 
-		ext2_read_block(sb, bgtable_begin+bl, sb->bg_table+512*sb->block_size*bl);
-}
-#endif
-
 /* read a block group descriptor into dest (32 bytes) */
 /* tmp is a scratch of at least 512 bytes */
 void ext2_get_bgdesc(struct ext2_sb *sb, uint32_t bg_num, char *tmp, char *dest) {
-	printf("ext2_get_bgdesc: bg_num=%d\n", bg_num);
+	pr_debug("ext2_get_bgdesc: bg_num=%d\n", bg_num);
 	/* if blocksize>1024B : superblock is at block 0+1024B, first block group descriptor in block 1+0B */
 	/* if blocksize==1024B: superblock is at block 1+0B, first block group descriptor in block 2+0B */
-	uint32_t bgtable_begin=2;   //(sb->block_size > 2 ? 1 : 2);
-	uint32_t off_absolute=512*(sb->part_offset+bgtable_begin*sb->block_size)+32*bg_num; // in bytes
-	uint32_t sector_number=off_absolute/512;
-	uint16_t off_into_sector=off_absolute%512;
-	printf("ext2_get_bgdesc: part_offset=%d block_size=%d bg_num=%d off_absolute=%d sector_number=%d off_into_sector=%d\n", 
-			sb->part_offset, sb->block_size, bg_num, off_absolute, sector_number, off_into_sector);
+	/* the descriptor table is contiguous and may span several blocks, so any bg_num can be reached */
+	uint32_t bgtable_begin=sb->first_data_block+1;
+	uint32_t off_into_table=sb->desc_size*bg_num; // in bytes
+	uint32_t sector_number=sb->part_offset+bgtable_begin*sb->block_size+off_into_table/512;
+	uint16_t off_into_sector=off_into_table%512;
+	pr_debug("ext2_get_bgdesc: part_offset=%d block_size=%d bg_num=%d off_into_table=%d sector_number=%d off_into_sector=%d\n", 
+			sb->part_offset, sb->block_size, bg_num, off_into_table, sector_number, off_into_sector);
 	mmc_bread(SDC_NO, sector_number, 1, tmp);
 	memcpy(dest, tmp+off_into_sector, 32);
 }
 
-/* read the block map of inode inode_num in bmap */
-/* tmp is a scratch workspace whose size is at least one sector */
+/* read the block map (or extent tree root) of inode inode_num in bmap, and its flags in flags */
+/* tmp is a scratch workspace whose size is at least two sectors */
 /* returns the size of the file, in bytes */
-uint32_t ext2_read_inode_block_map(struct ext2_sb *sb, int inode_num, char *tmp, uint32_t *bmap) {
+uint32_t ext2_read_inode_block_map(struct ext2_sb *sb, int inode_num, char *tmp, uint32_t *bmap, uint32_t *flags) {
 	/* get location of inode table of the block group of the inode */
 	uint32_t bg_of_inode=(inode_num-1)/sb->inodes_per_group;
 	ext2_get_bgdesc(sb, bg_of_inode, tmp+512, tmp);
 	uint32_t inode_table_block_nr=INAT(uint32_t, tmp, 0x8);
-	printf("inode %d is in block group %d, inode table of this block group starts at block %d\n", 
+	pr_debug("inode %d is in block group %d, inode table of this block group starts at block %d\n", 
 				inode_num, bg_of_inode, inode_table_block_nr);
 	/* get location of this inode in its inode table */
 	uint32_t off_into_bg_inode_table=sb->inode_size*((inode_num-1)%sb->inodes_per_group);
-	printf("A=%d B=%d C=%d\n", sb->inode_size, inode_num, sb->inodes_per_group);
-	uint32_t abs_inode=(sb->part_offset+inode_table_block_nr*sb->block_size)*512+off_into_bg_inode_table; /* in bytes */
-	uint32_t sector_nr=abs_inode/512;
-	uint32_t off_into_sector=abs_inode%512;
-	printf("inode info at offset %d into inode table of block group = absolute byte %d, sector %d, off into sector %d \n", 
-				off_into_bg_inode_table, abs_inode, sector_nr, off_into_sector);
+	pr_debug("A=%d B=%d C=%d\n", sb->inode_size, inode_num, sb->inodes_per_group);
+	uint32_t sector_nr=sb->part_offset+inode_table_block_nr*sb->block_size+off_into_bg_inode_table/512;
+	uint32_t off_into_sector=off_into_bg_inode_table%512;
+	pr_debug("inode info at offset %d into inode table of block group = sector %d, off into sector %d \n", 
+				off_into_bg_inode_table, sector_nr, off_into_sector);
 	/* fetch the sector containing requested inode */
 	mmc_bread(SDC_NO, sector_nr, 1, tmp);
 
 	/* copy block map */
 	memcpy((char*)bmap, tmp+off_into_sector+0x28, 60);
-	printf("got block map: \n");
-	for(int i=0; i<15; i++) printf("%d ", bmap[i]);
-	printf("\n");
+	pr_debug("got block map: \n");
+	for(int i=0; i<15; i++) pr_debug("%d ", bmap[i]);
+	pr_debug("\n");
+
+	*flags=INAT(uint32_t, tmp, off_into_sector+0x20);
 
 	/* get file size */
 	uint32_t fsize=INAT(uint32_t, tmp, off_into_sector+0x4); 
-	printf("file size=%d\n", fsize);
+	pr_debug("file size=%d\n", fsize);
 
 	return(fsize);
 }
 
-/* read at most bcount blocks whose numbers are in NULL-terminated blist, 
- * returns number of blocks effectively read */
-int ext2_read_block_list(struct ext2_sb *sb, uint32_t *blist, int bcount, char *dest) {
+/* run of physically contiguous blocks, read with a single mmc_bread() */
+struct ext2_run {
+	uint32_t start; /* first block of the run */
+	uint32_t count; /* number of blocks in the run, 0 if empty */
+	char *dest; /* where the first block of the run goes */
+	uint32_t nreads; /* number of mmc_bread() issued so far */
+};
+
+#ifdef CFG_SUNXI_SHA256
+/* file being hashed as its runs are read: each run is hashed while the next one is in flight */
+struct ext2_hash {
+	sha256_context ctx;
+	char *file; /* load address of the file to hash, NULL if none */
+	char *next; /* next byte of the file to hash, NULL when not hashing */
+	uint32_t left; /* bytes of the file not hashed yet */
+	char *pend; /* run read last, not hashed yet */
+	uint32_t pend_len;
+	int late; /* runs came out of file order, hash the file once loaded */
+};
+struct ext2_hash ext2_hash;
+
+/* hash the run read last, if it follows what was hashed so far */
+void ext2_hash_pending(void) {
+	if(!ext2_hash.pend) return;
+	if(ext2_hash.pend!=ext2_hash.next) {
+		ext2_hash.late=1;
+	} else if(!ext2_hash.late) {
+		uint32_t n=(ext2_hash.pend_len>ext2_hash.left ? ext2_hash.left : ext2_hash.pend_len);
+		sha256_update(&ext2_hash.ctx, (uint8_t*)ext2_hash.pend, n);
+		ext2_hash.next+=n;
+		ext2_hash.left-=n;
+	}
+	ext2_hash.pend=NULL;
+}
+#endif
+
+/* issue the pending run, if any */
+int ext2_run_flush(struct ext2_sb *sb, struct ext2_run *run) {
+	if(!run->count) return(0);
+	uint32_t nsect=run->count*sb->block_size;
+#ifdef CFG_SUNXI_SHA256
+	if(ext2_hash.next) {
+		if(mmc_bread_async(SDC_NO, sb->part_offset+run->start*sb->block_size, nsect, run->dest)!=nsect
+				|| (ext2_hash_pending(), mmc_wait(SDC_NO)!=nsect)) {
+			pr_err("read of %d blocks from block %d failed\n", run->count, run->start);
+			run->count=0;
+			return(-1);
+		}
+		ext2_hash.pend=run->dest;
+		ext2_hash.pend_len=nsect*512;
+	} else
+#endif
+	if(mmc_bread(SDC_NO, sb->part_offset+run->start*sb->block_size, nsect, run->dest)!=nsect) {
+		pr_err("read of %d blocks from block %d failed\n", run->count, run->start);
+		run->count=0;
+		return(-1);
+	}
+	run->nreads++;
+	run->count=0;
+	return(0);
+}
+
+/* append block block_num (to be stored at dest) to the pending run; */
+/* the run is flushed first if block_num does not extend it, or if it would exceed max_run */
+int ext2_run_add(struct ext2_sb *sb, struct ext2_run *run, uint32_t block_num, char *dest) {
+	if(run->count && block_num==run->start+run->count 
+			&& dest==run->dest+run->count*512*sb->block_size
+			&& (run->count+1)*sb->block_size<=sb->max_run) {
+		run->count++;
+		return(0);
+	}
+	if(ext2_run_flush(sb, run)<0) return(-1);
+	run->start=block_num;
+	run->count=1;
+	run->dest=dest;
+	return(0);
+}
+
+/* queue at most bcount blocks whose numbers are in NULL-terminated blist into run, 
+ * returns number of blocks effectively queued, or -1 if a read failed */
+int ext2_read_block_list(struct ext2_sb *sb, uint32_t *blist, int bcount, char *dest, struct ext2_run *run) {
+	PMU_SCOPE(scope, "ext2_read_block_list");
 	int i;
+	pmu_begin(&scope);
 	for(i=0; i<bcount; i++) {
 		if(blist[i]==0) break;
-		ext2_read_block(sb, blist[i], dest+i*sb->block_size*512);
+		if(ext2_run_add(sb, run, blist[i], dest+i*sb->block_size*512)<0) {
+			i=-1;
+			break;
+		}
 	}
+	pmu_end(&scope);
 	return(i);
 }
 
 /* read from double-indirect(level=2) or indirect(level=1) addr in block map */
 /* tmp is a scratch holding at least (level) blocks */
-int ext2_read_bmap_indirect(int level, struct ext2_sb *sb, uint32_t addr, int max_block_count, char *tmp, char *dest) {
-	uint32_t *iblist=(uint32_t*)(tmp+1024*(level-1)); // blocksize<=1024 => number of block addr in a sector<=256
-	ext2_read_block(sb, addr, (char*)iblist);
+/* returns number of blocks queued, or -1 if a read failed */
+int ext2_read_bmap_indirect(int level, struct ext2_sb *sb, uint32_t addr, int max_block_count, char *tmp, char *dest, struct ext2_run *run) {
+	uint32_t *iblist=(uint32_t*)(tmp+512*sb->block_size*(level-1));
+	if(ext2_read_block(sb, addr, (char*)iblist)<0) return(-1);
 	int max_block_addr_in_block=(512*sb->block_size)/4;
 	int blocks_read=0;
 	if(level==1) {
 		int blk_count=max_block_addr_in_block;
 		if(blk_count>max_block_count) blk_count=max_block_count;
-		blocks_read=ext2_read_block_list(sb, iblist, blk_count, dest);
+		blocks_read=ext2_read_block_list(sb, iblist, blk_count, dest, run);
 		return(blocks_read);
 	} else if(level>1) {
-		for(int i=0; i<max_block_addr_in_block && blocks_read<=max_block_count; i++) {
-			blocks_read += ext2_read_bmap_indirect(level-1, sb, iblist[i], max_block_count-blocks_read, tmp, dest+blocks_read*512*sb->block_size);
+		for(int i=0; i<max_block_addr_in_block && blocks_read<max_block_count && iblist[i]; i++) {
+			int rc=ext2_read_bmap_indirect(level-1, sb, iblist[i], max_block_count-blocks_read, tmp, dest+blocks_read*512*sb->block_size, run);
+			if(rc<0) return(-1);
+			blocks_read+=rc;
 		}
 		return(blocks_read);
 	} else {
-		printf("Shouldn't happen\n");
+		pr_err("Shouldn't happen\n");
 		return(0);
 	}
 }
 
 
 /* read contents (at most maxBlockNumber blocks) of an inode given its 60-byte block map */
+/* physically contiguous blocks are coalesced and read with a single mmc_bread() */
 /* tmp is a scratch holding at least 2 blocks */
-/* returns number of blocks effectively read */
+/* returns number of blocks effectively read, or -1 on error */
 int ext2_read_bmap_contents(struct ext2_sb *sb, uint32_t *bmap, int max_block_count, char *tmp, char *dest) {
 	int rc;
 	int blocks_read;
+	struct ext2_run run={0, 0, dest, 0};
 
 	/* direct blocks */
-	rc=ext2_read_block_list(sb, bmap, (max_block_count>12 ? 12 : max_block_count), dest);
+	rc=ext2_read_block_list(sb, bmap, (max_block_count>12 ? 12 : max_block_count), dest, &run);
+	if(rc<0) return(-1);
 	blocks_read=rc;
 	max_block_count-=rc;
-	if(max_block_count<=0 || !bmap[12]) return(blocks_read);
+	if(max_block_count<=0 || !bmap[12]) goto out;
 
 	/* indirect block */
-	rc=ext2_read_bmap_indirect(1, sb, bmap[12], max_block_count, tmp, dest+blocks_read*512*sb->block_size);
+	rc=ext2_read_bmap_indirect(1, sb, bmap[12], max_block_count, tmp, dest+blocks_read*512*sb->block_size, &run);
+	if(rc<0) return(-1);
 	blocks_read+=rc;
 	max_block_count-=rc;
-	if(max_block_count<=0 || !bmap[13]) return(blocks_read);
+	if(max_block_count<=0 || !bmap[13]) goto out;
 
 	/* double-indirect block */
-	rc=ext2_read_bmap_indirect(2, sb, bmap[13], max_block_count, tmp, dest+blocks_read*512*sb->block_size);
+	rc=ext2_read_bmap_indirect(2, sb, bmap[13], max_block_count, tmp, dest+blocks_read*512*sb->block_size, &run);
+	if(rc<0) return(-1);
 	blocks_read+=rc;
 	max_block_count-=rc;
-	if(max_block_count<=0 || !bmap[14]) return(blocks_read);
+	if(max_block_count<=0 || !bmap[14]) goto out;
 
 	/* triple-indirect block */
 	if(bmap[14]) {
-		printf("Warning: file truncated, triple-indirect block map not supported)\n");
+		pr_warn("Warning: file truncated, triple-indirect block map not supported)\n");
 	}
 
+out:
+	if(ext2_run_flush(sb, &run)<0) return(-1);
+	pr_debug("%d blocks read in %d requests\n", blocks_read, run.nreads);
 	return(blocks_read);
 }
 
-/* reads at most max_block_count blocks of the data whose inode is inode_num */
-/* tmp is a scratch of at least 60 bytes+2 blocks */
-int ext2_read_inode_contents(struct ext2_sb *sb, uint32_t inode_num, int max_block_count, char *tmp, char *dest) {
-	uint32_t *bmap=(uint32_t*)(tmp+2*512*sb->block_size);
-	uint32_t fsize=ext2_read_inode_block_map(sb, inode_num, dest, bmap); // use dest as scratch
+/* queue the blocks of extent tree node (header followed by entries) into run, */
+/* skipping those beyond max_block_count; each block goes at dest+(its logical block number) */
+/* *next is the logical block after the last one mapped so far: holes before an extent and */
+/* unwritten extents are zeroed, as they read */
+/* tmp is a scratch holding at least (depth of node) blocks */
+/* returns number of blocks queued or zeroed, or -1 on error */
+int ext4_read_extents(struct ext2_sb *sb, char *node, int max_block_count, char *tmp, char *dest, struct ext2_run *run, uint32_t *next) {
+	if(INAT(uint16_t, node, 0)!=EXT4_EXT_MAGIC) {
+		pr_err("bad extent header magic (%x)\n", INAT(uint16_t, node, 0));
+		return(-1);
+	}
+	int entries=INAT(uint16_t, node, 0x2);
+	int depth=INAT(uint16_t, node, 0x6);
+	if(depth>EXT4_EXT_MAX_DEPTH) {
+		pr_err("extent tree too deep (%d)\n", depth);
+		return(-1);
+	}
+	int blocks_read=0;
+	for(int i=0; i<entries; i++) {
+		char *e=node+12*(i+1); /* entries follow the 12-byte header */
+		uint32_t lblock=INAT(uint32_t, e, 0);
+		if(lblock>=max_block_count) break;
+		if(depth>0) {
+			/* index node: ei_block, ei_leaf_lo, ei_leaf_hi */
+			char *child=tmp+512*sb->block_size*(depth-1);
+			if(INAT(uint16_t, e, 0x8) || ext2_read_block(sb, INAT(uint32_t, e, 0x4), child)<0)
+				return(-1);
+			int rc=ext4_read_extents(sb, child, max_block_count, tmp, dest, run, next);
+			if(rc<0) return(-1);
+			blocks_read+=rc;
+		} else {
+			/* leaf node: ee_block, ee_len, ee_start_hi, ee_start_lo */
+			uint32_t len=INAT(uint16_t, e, 0x4);
+			uint32_t start=INAT(uint32_t, e, 0x8);
+			int uninit=(len>32768);
+			if(uninit) len-=32768;
+			if(INAT(uint16_t, e, 0x6)) {
+				pr_err("extent beyond 2^32 blocks\n");
+				return(-1);
+			}
+			if(lblock+len>max_block_count) len=max_block_count-lblock;
+			if(lblock>*next) {
+				/* hole */
+				memset(dest+*next*512*sb->block_size, 0, (lblock-*next)*512*sb->block_size);
+				blocks_read+=lblock-*next;
+			}
+			if(lblock+len>*next) *next=lblock+len;
+			char *edest=dest+lblock*512*sb->block_size;
+			if(uninit) {
+				/* preallocated but unwritten extent reads as zeroes */
+				memset(edest, 0, len*512*sb->block_size);
+			} else {
+				for(uint32_t j=0; j<len; j++) {
+					if(ext2_run_add(sb, run, start+j, edest+j*512*sb->block_size)<0) return(-1);
+				}
+			}
+			blocks_read+=len;
+		}
+	}
+	return(blocks_read);
+}
+
+/* read contents (at most max_block_count blocks) of an inode given its 60-byte extent tree root */
+/* tmp is a scratch holding at least EXT4_EXT_MAX_DEPTH blocks */
+/* returns number of blocks effectively read, or -1 on error */
+int ext4_read_extent_contents(struct ext2_sb *sb, char *root, int max_block_count, char *tmp, char *dest) {
+	struct ext2_run run={0, 0, dest, 0};
+	uint32_t next=0;
+	int blocks_read=ext4_read_extents(sb, root, max_block_count, tmp, dest, &run, &next);
+	if(blocks_read>=0 && next<max_block_count) {
+		/* hole up to the end of the file */
+		memset(dest+next*512*sb->block_size, 0, (max_block_count-next)*512*sb->block_size);
+		blocks_read+=max_block_count-next;
+	}
+	if(ext2_run_flush(sb, &run)<0 || blocks_read<0) return(-1);
+	pr_debug("%d blocks read in %d requests\n", blocks_read, run.nreads);
+	return(blocks_read);
+}
+
+/* read the data (at most max_block_count blocks) of a file of size fsize given its block map and flags */
+/* tmp is a scratch of at least 2 blocks */
+/* returns number of blocks effectively read, or -1 on error */
+int ext2_read_map_contents(struct ext2_sb *sb, uint32_t *bmap, uint32_t flags, uint32_t fsize, int max_block_count, char *tmp, char *dest) {
 	int block_count=(fsize+512*sb->block_size-1)/(512*sb->block_size);
 	if(max_block_count<block_count) {
-		printf("Warning: block_count of file (%d) is larger than max_block_count (%d); file will be truncated\n", block_count, max_block_count);
+		pr_warn("Warning: block_count of file (%d) is larger than max_block_count (%d); file will be truncated\n", block_count, max_block_count);
 	} else {
 		max_block_count=block_count;
-		printf("max_block_count set to %d\n", block_count);
+		pr_debug("max_block_count set to %d\n", block_count);
 	}
-	ext2_read_bmap_contents(sb, bmap, max_block_count, tmp, dest);
+	if(flags & EXT4_EXTENTS_FL)
+		return(ext4_read_extent_contents(sb, (char*)bmap, max_block_count, tmp, dest));
+	else
+		return(ext2_read_bmap_contents(sb, bmap, max_block_count, tmp, dest));
+}
+
+/* reads at most max_block_count blocks of the data whose inode is inode_num */
+/* tmp is a scratch of at least 60 bytes+2 blocks */
+int ext2_read_inode_contents(struct ext2_sb *sb, uint32_t inode_num, int max_block_count, char *tmp, char *dest) {
+	uint32_t *bmap=(uint32_t*)(tmp+2*512*sb->block_size);
+	uint32_t flags;
+	uint32_t fsize=ext2_read_inode_block_map(sb, inode_num, dest, bmap, &flags); // use dest as scratch
+	ext2_read_map_contents(sb, bmap, flags, fsize, max_block_count, tmp, dest);
 	return(fsize);
 }
 
+/* physical block holding logical block lblock of a file given its block map (or extent tree root) and flags */
+/* tmp is a scratch of at least one block */
+/* returns 0 for holes, unwritten extents, or on error */
+uint32_t ext2_bmap_lookup(struct ext2_sb *sb, uint32_t *bmap, uint32_t flags, uint32_t lblock, char *tmp) {
+	if(flags & EXT4_EXTENTS_FL) {
+		char *node=(char*)bmap;
+		for(;;) {
+			if(INAT(uint16_t, node, 0)!=EXT4_EXT_MAGIC) return(0);
+			int entries=INAT(uint16_t, node, 0x2);
+			int depth=INAT(uint16_t, node, 0x6);
+			/* last entry starting at or before lblock; entries are sorted */
+			int i;
+			for(i=0; i<entries && INAT(uint32_t, node, 12*(i+1))<=lblock; i++);
+			if(i==0) return(0);
+			char *e=node+12*i;
+			if(depth==0) {
+				uint32_t len=INAT(uint16_t, e, 0x4);
+				if(len>32768 || lblock>=INAT(uint32_t, e, 0)+len) return(0);
+				return(INAT(uint32_t, e, 0x8)+lblock-INAT(uint32_t, e, 0));
+			}
+			if(ext2_read_block(sb, INAT(uint32_t, e, 0x4), tmp)<0) return(0);
+			node=tmp;
+		}
+	} else {
+		uint32_t p=(512*sb->block_size)/4; /* block addresses per block */
+		if(lblock<12) return(bmap[lblock]);
+		lblock-=12;
+		if(lblock<p) {
+			if(!bmap[12] || ext2_read_block(sb, bmap[12], tmp)<0) return(0);
+			return(((uint32_t*)tmp)[lblock]);
+		}
+		lblock-=p;
+		if(lblock<p*p) {
+			if(!bmap[13] || ext2_read_block(sb, bmap[13], tmp)<0) return(0);
+			uint32_t ind=((uint32_t*)tmp)[lblock/p];
+			if(!ind || ext2_read_block(sb, ind, tmp)<0) return(0);
+			return(((uint32_t*)tmp)[lblock%p]);
+		}
+		return(0);
+	}
+}
+
 /* returns inode number from filename and (linear) directory entry */
 uint32_t ext2_inode_num(struct ext2_sb *sb, char *filename, uint16_t name_len, char *dirent, int dirent_size) {
 	int idx=0;
 	while(idx<dirent_size) {
-		uint16_t c_name_len=INAT(uint16_t, dirent, idx+0x6);
-		if(c_name_len != name_len) {
+		uint16_t c_name_len=INAT(uint8_t, dirent, idx+0x6); /* byte 0x7 holds the file type with the filetype feature */
+		if(c_name_len != name_len || INAT(uint32_t, dirent, idx)==0) { /* inode 0 : unused entry */
 			//printf("c_name_len=%d, mismatch %d\n", c_name_len, name_len);
 		} else {
 			if(memcmp(filename, dirent+idx+0x8, name_len)==0) {
 				uint32_t inode_num=INAT(uint32_t, dirent, idx);
-				printf("%s is at inode %d\n", filename, inode_num);
+				pr_debug("%s is at inode %d\n", filename, inode_num);
 				return(inode_num);
 			} else { 
 				//printf("name mismatch\n"); 
@@ -273,22 +539,541 @@ uint32_t ext2_inode_num(struct ext2_sb *sb, char *filename, uint16_t name_len, c
 	return(0); // not found
 }
 
-#define LOAD_SCRATCH  0x01010000
-#define LOAD_SCRATCH2 0x01100000
+/* directory hashes, as in linux fs/ext4/hash.c */
+#define ROL32(x, n) (((x) << (n)) | ((x) >> (32-(n))))
+#define DX_F(x, y, z) ((z) ^ ((x) & ((y) ^ (z))))
+#define DX_G(x, y, z) (((x) & (y)) + (((x) ^ (y)) & (z)))
+#define DX_H(x, y, z) ((x) ^ (y) ^ (z))
+#define DX_ROUND(f, a, b, c, d, x, s) (a += f(b, c, d) + (x), a = ROL32(a, s))
+#define DX_K2 013240474631U
+#define DX_K3 015666365641U
+
+void ext2_half_md4_transform(uint32_t *buf, uint32_t *in) {
+	uint32_t a=buf[0], b=buf[1], c=buf[2], d=buf[3];
+
+	DX_ROUND(DX_F, a, b, c, d, in[0],  3);
+	DX_ROUND(DX_F, d, a, b, c, in[1],  7);
+	DX_ROUND(DX_F, c, d, a, b, in[2], 11);
+	DX_ROUND(DX_F, b, c, d, a, in[3], 19);
+	DX_ROUND(DX_F, a, b, c, d, in[4],  3);
+	DX_ROUND(DX_F, d, a, b, c, in[5],  7);
+	DX_ROUND(DX_F, c, d, a, b, in[6], 11);
+	DX_ROUND(DX_F, b, c, d, a, in[7], 19);
+
+	DX_ROUND(DX_G, a, b, c, d, in[1]+DX_K2,  3);
+	DX_ROUND(DX_G, d, a, b, c, in[3]+DX_K2,  5);
+	DX_ROUND(DX_G, c, d, a, b, in[5]+DX_K2,  9);
+	DX_ROUND(DX_G, b, c, d, a, in[7]+DX_K2, 13);
+	DX_ROUND(DX_G, a, b, c, d, in[0]+DX_K2,  3);
+	DX_ROUND(DX_G, d, a, b, c, in[2]+DX_K2,  5);
+	DX_ROUND(DX_G, c, d, a, b, in[4]+DX_K2,  9);
+	DX_ROUND(DX_G, b, c, d, a, in[6]+DX_K2, 13);
+
+	DX_ROUND(DX_H, a, b, c, d, in[3]+DX_K3,  3);
+	DX_ROUND(DX_H, d, a, b, c, in[7]+DX_K3,  9);
+	DX_ROUND(DX_H, c, d, a, b, in[2]+DX_K3, 11);
+	DX_ROUND(DX_H, b, c, d, a, in[6]+DX_K3, 15);
+	DX_ROUND(DX_H, a, b, c, d, in[1]+DX_K3,  3);
+	DX_ROUND(DX_H, d, a, b, c, in[5]+DX_K3,  9);
+	DX_ROUND(DX_H, c, d, a, b, in[0]+DX_K3, 11);
+	DX_ROUND(DX_H, b, c, d, a, in[4]+DX_K3, 15);
+
+	buf[0]+=a; buf[1]+=b; buf[2]+=c; buf[3]+=d;
+}
+
+void ext2_tea_transform(uint32_t *buf, uint32_t *in) {
+	uint32_t sum=0, b0=buf[0], b1=buf[1];
+	for(int n=0; n<16; n++) {
+		sum+=0x9E3779B9;
+		b0+=((b1 << 4)+in[0]) ^ (b1+sum) ^ ((b1 >> 5)+in[1]);
+		b1+=((b0 << 4)+in[2]) ^ (b0+sum) ^ ((b0 >> 5)+in[3]);
+	}
+	buf[0]+=b0;
+	buf[1]+=b1;
+}
+
+/* pack (at most 4*num bytes of) msg into num words, padded with the length */
+void ext2_str2hashbuf(char *msg, int len, uint32_t *buf, int num, int is_unsigned) {
+	uint32_t pad, val;
+	pad=(uint32_t)len | ((uint32_t)len << 8);
+	pad|=pad << 16;
+	val=pad;
+	if(len>num*4) len=num*4;
+	for(int i=0; i<len; i++) {
+		int c=(is_unsigned ? (int)(uint8_t)msg[i] : (int)(int8_t)msg[i]);
+		val=c+(val << 8);
+		if((i%4)==3) {
+			*buf++=val;
+			val=pad;
+			num--;
+		}
+	}
+	if(--num>=0) *buf++=val;
+	while(--num>=0) *buf++=pad;
+}
+
+/* hash of name for htree lookups, returns 0 and sets hash if hash_version is supported */
+int ext2_dirhash(struct ext2_sb *sb, int hash_version, char *name, int len, uint32_t *hash) {
+	uint32_t buf[4]={0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476};
+	uint32_t in[8];
+	int is_unsigned=(hash_version>=DX_HASH_LEGACY_UNSIGNED);
+
+	if(sb->hash_seed[0] || sb->hash_seed[1] || sb->hash_seed[2] || sb->hash_seed[3])
+		memcpy((char*)buf, (char*)sb->hash_seed, 16);
+
+	switch(hash_version) {
+	case DX_HASH_LEGACY:
+	case DX_HASH_LEGACY_UNSIGNED: {
+		uint32_t h, h0=0x12a3fe2d, h1=0x37abe8f9;
+		for(int i=0; i<len; i++) {
+			int c=(is_unsigned ? (int)(uint8_t)name[i] : (int)(int8_t)name[i]);
+			h=h1+(h0 ^ (c*7152373));
+			if(h & 0x80000000) h-=0x7fffffff;
+			h1=h0;
+			h0=h;
+		}
+		*hash=h0 << 1;
+		break;
+	}
+	case DX_HASH_HALF_MD4:
+	case DX_HASH_HALF_MD4_UNSIGNED:
+		for(; len>0; len-=32, name+=32) {
+			ext2_str2hashbuf(name, len, in, 8, is_unsigned);
+			ext2_half_md4_transform(buf, in);
+		}
+		*hash=buf[1];
+		break;
+	case DX_HASH_TEA:
+	case DX_HASH_TEA_UNSIGNED:
+		for(; len>0; len-=16, name+=16) {
+			ext2_str2hashbuf(name, len, in, 4, is_unsigned);
+			ext2_tea_transform(buf, in);
+		}
+		*hash=buf[0];
+		break;
+	default:
+		return(-1);
+	}
+	*hash&=~1;
+	if(*hash==0xfffffffe) *hash=0xfffffffc; /* reserved for end of directory */
+	return(0);
+}
+
+/* lookup name in an htree-indexed directory given its block map and flags */
+/* tmp is a scratch of at least 2 blocks, buf of at least 1 block */
+/* returns inode number, 0 if not found, -1 if the index cannot be used */
+int ext2_htree_lookup(struct ext2_sb *sb, uint32_t *bmap, uint32_t flags, char *name, int name_len, char *tmp, char *buf) {
+	int bsize=512*sb->block_size;
+	char *node=tmp+bsize; /* dx_root, then dx_node blocks */
+	uint32_t blk=ext2_bmap_lookup(sb, bmap, flags, 0, tmp);
+	if(!blk || ext2_read_block(sb, blk, node)<0) return(-1);
+
+	/* dx_root: "." and ".." entries, then dx_root_info at 0x18, then dx entries */
+	int hash_version=INAT(uint8_t, node, 0x1c);
+	int info_length=INAT(uint8_t, node, 0x1d);
+	int levels=INAT(uint8_t, node, 0x1e);
+	if(INAT(uint32_t, node, 0x18)!=0 || levels>sb->dx_max_levels) {
+		pr_warn("bad htree root\n");
+		return(-1);
+	}
+	if(hash_version<=DX_HASH_TEA) hash_version+=sb->hash_unsigned;
+	uint32_t hash;
+	if(ext2_dirhash(sb, hash_version, name, name_len, &hash)<0) {
+		pr_warn("unsupported directory hash (%d)\n", hash_version);
+		return(-1);
+	}
+
+	/* dx entries: { limit, count, block } then { hash, block }, sorted by hash */
+	char *entries=node+0x18+info_length;
+	int count, i;
+	for(int level=0; ; level++) {
+		count=INAT(uint16_t, entries, 0x2);
+		if(count==0 || 8*count>bsize) return(-1);
+		/* last entry whose hash is <= hash, entry 0 covers hashes from 0 */
+		int lo=1, hi=count-1;
+		while(lo<=hi) {
+			int mid=(lo+hi)/2;
+			if(INAT(uint32_t, entries, 8*mid)>hash) hi=mid-1;
+			else lo=mid+1;
+		}
+		i=lo-1;
+		if(level==levels) break;
+		/* dx_node: fake empty directory entry of 8 bytes, then dx entries */
+		if(!(blk=ext2_bmap_lookup(sb, bmap, flags, INAT(uint32_t, entries, 8*i+4), tmp)) || ext2_read_block(sb, blk, node)<0) 
+			return(-1);
+		entries=node+0x8;
+	}
+
+	/* scan the leaf, and the following ones while they continue the same hash */
+	for(;;) {
+		if(!(blk=ext2_bmap_lookup(sb, bmap, flags, INAT(uint32_t, entries, 8*i+4), tmp)) || ext2_read_block(sb, blk, buf)<0)
+			return(-1);
+		uint32_t inum=ext2_inode_num(sb, name, name_len, buf, bsize);
+		if(inum) return(inum);
+		if(++i>=count) break;
+		uint32_t next_hash=INAT(uint32_t, entries, 8*i);
+		if(!(next_hash & 1) || (next_hash & ~1)!=hash) break;
+	}
+	return(0);
+}
+
+/* lookup name (name_len bytes, not NUL-terminated) in directory of inode dir_inum */
+/* tmp is a scratch of at least 60 bytes+2 blocks, dirbuf a scratch of DIR_MAX_SIZE bytes */
+/* returns inode number, 0 if not found */
+uint32_t ext2_dir_lookup(struct ext2_sb *sb, uint32_t dir_inum, char *name, int name_len, char *tmp, char *dirbuf) {
+	uint32_t *bmap=(uint32_t*)(tmp+2*512*sb->block_size);
+	uint32_t flags;
+	uint32_t dsize=ext2_read_inode_block_map(sb, dir_inum, dirbuf, bmap, &flags);
+	if(sb->dir_index && (flags & EXT2_INDEX_FL)) {
+		int inum=ext2_htree_lookup(sb, bmap, flags, name, name_len, tmp, dirbuf);
+		if(inum>=0) return(inum);
+		pr_warn("htree lookup failed, falling back to linear scan\n");
+	}
+	/* linear scan of the whole directory */
+	int nblocks=ext2_read_map_contents(sb, bmap, flags, dsize, DIR_MAX_SIZE/(512*sb->block_size), tmp, dirbuf);
+	if(nblocks<0) return(0);
+	if(dsize>nblocks*512*sb->block_size) dsize=nblocks*512*sb->block_size;
+	return(ext2_inode_num(sb, name, name_len, dirbuf, dsize));
+}
+
+/* resolve path (relative to /, components separated by '/') to an inode number */
+/* returns 0 if not found */
+uint32_t ext2_namei(struct ext2_sb *sb, char *path, char *tmp, char *dirbuf) {
+	uint32_t inum=2; /* root directory */
+	while(*path) {
+		if(*path=='/') {
+			path++;
+			continue;
+		}
+		int len=0;
+		while(path[len] && path[len]!='/') len++;
+		if(len>255 || !(inum=ext2_dir_lookup(sb, inum, path, len, tmp, dirbuf))) {
+			pr_info("%s: not found\n", path);
+			return(0);
+		}
+		path+=len;
+	}
+	return(inum);
+}
+
+/* scratch layout, at the start of the boot0 work area (CONFIG_BOOT0_WORK_BASE) : */
+/*   LOAD_SCRATCH2 : MBR (512 bytes), superblock (1024 bytes) */
+/*   LOAD_SCRATCH  : block map walk (2 blocks + 60-byte block map), LOAD_SCRATCH_SIZE bytes */
+/*   followed by directory contents, DIR_MAX_SIZE bytes */
+/*   LOAD_MANIFEST : boot manifest, MANIFEST_MAX_SIZE bytes, kept until boot0 patches the FDT */
+/*   the rest of the work area holds the malloc() heap of the decompressors */
+/*   LOAD_STAGING  : compressed files, before they are decompressed at their load address */
+#define LOAD_SCRATCH2 (CONFIG_BOOT0_WORK_BASE-SDRAM_OFFSET(0))
+#define LOAD_SCRATCH  (LOAD_SCRATCH2+2048)
+#define LOAD_SCRATCH_SIZE(sb) (3*512*(sb)->block_size)
+#define LOAD_MANIFEST (LOAD_SCRATCH+3*512*MAX_BLOCK_SIZE+DIR_MAX_SIZE)
+#define LOAD_STAGING  (LOAD_SCRATCH2+CONFIG_BOOT0_WORK_SIZE)
+#define MANIFEST_MAX_SIZE 4096
+#define LOAD_MAX_SIZE 0x4000000 /* largest file or decompressed image */
+
+/* DRAM ranges [start, end) kept out of the loads : boot0's own areas, then the files loaded so far */
+struct ext2_range {
+	phys_addr_t start;
+	phys_addr_t end;
+};
+#define LOAD_RANGES_MAX 16
+#define LOAD_RANGES_BOOT0 2
+struct ext2_range ext2_ranges[LOAD_RANGES_MAX]={
+	{CONFIG_BOOT0_BLOG_BASE, CONFIG_BOOT0_TIMELINE_BASE+CONFIG_BOOT0_TIMELINE_SIZE}, /* logs and timeline */
+	{CONFIG_BOOT0_WORK_BASE, CONFIG_BOOT0_WORK_BASE+CONFIG_BOOT0_WORK_SIZE}, /* scratch, mmc ring, heap */
+};
+int ext2_nranges=LOAD_RANGES_BOOT0;
+
+/* bytes available at addr before the next range in use, 0 if addr is in one */
+uint32_t ext2_room(phys_addr_t addr) {
+	phys_addr_t limit=addr+LOAD_MAX_SIZE;
+	if(addr<SDRAM_OFFSET(0)) return(0);
+	for(int i=0; i<ext2_nranges; i++) {
+		if(addr>=ext2_ranges[i].start && addr<ext2_ranges[i].end) return(0);
+		if(addr<ext2_ranges[i].start && limit>ext2_ranges[i].start) limit=ext2_ranges[i].start;
+	}
+	return(limit-addr);
+}
+
+/* keep [addr, addr+size) out of the following loads; returns -1 if there are too many ranges */
+int ext2_reserve(phys_addr_t addr, uint32_t size) {
+	if(ext2_nranges==LOAD_RANGES_MAX) {
+		pr_err("more than %d files\n", LOAD_RANGES_MAX-LOAD_RANGES_BOOT0);
+		return(-1);
+	}
+	ext2_ranges[ext2_nranges].start=addr;
+	ext2_ranges[ext2_nranges].end=addr+size;
+	ext2_nranges++;
+	return(0);
+}
+
+/* load file path at addr, using dirbuf for directory lookups; it must fit in max_size bytes */
+/* returns the size of the file, or -1 on error */
+int ext2_load_file(struct ext2_sb *sb, char *path, char *dirbuf, phys_addr_t addr, uint32_t max_size) {
+	char *tmp=(char*)(SDRAM_OFFSET(LOAD_SCRATCH));
+	uint32_t *bmap=(uint32_t*)(tmp+2*512*sb->block_size);
+	uint32_t flags;
+	int rc;
+	pr_info("Loading %s at 0x%x... \n", path, addr);
+	uint32_t inum=ext2_namei(sb, path, tmp, dirbuf);
+	if(!inum) {
+		pr_err("file not found\n");
+		return(-1);
+	}
+	uint32_t fsize=ext2_read_inode_block_map(sb, inum, dirbuf, bmap, &flags);
+	int block_count=(fsize+512*sb->block_size-1)/(512*sb->block_size);
+	if(fsize>max_size) {
+		pr_err("%s : size %d larger than %d bytes available at 0x%x\n", path, fsize, max_size, addr);
+		return(-1);
+	}
+#ifdef CFG_SUNXI_SHA256
+	if(ext2_hash.file==(char*)addr) {
+		ext2_hash.next=(char*)addr;
+		ext2_hash.left=fsize;
+		ext2_hash.late=0;
+	}
+#endif
+	rc=ext2_read_map_contents(sb, bmap, flags, fsize, block_count, tmp, (char*)addr);
+#ifdef CFG_SUNXI_SHA256
+	if(ext2_hash.next) {
+		ext2_hash_pending();
+		if(ext2_hash.left) ext2_hash.late=1;
+		ext2_hash.next=NULL;
+	}
+#endif
+	if(rc!=block_count) {
+		pr_err("%s : read error\n", path);
+		return(-1);
+	}
+	pr_info("End at 0x%x\n", addr+fsize);
+	return(fsize);
+}
+
+/* boot manifest : /boot0.cfg, or default_manifest if there is none. One entry per line, */
+/*   <kind> <path> <load address> [gz|lz4|lzma] [crc32=<hex>] [sha256=<64 hex digits>] */
+/*   cmdline <kernel command line, set as /chosen/bootargs> */
+/* kind is opensbi, dtb, kernel (the payload run by opensbi) or file (only loaded). */
+/* A file must not run into those loaded before it, nor into boot0's logs or work area. */
+/* sha256 is of the file as stored, hashed as it is read, like the TOC1 item hashes; crc32 is of */
+/* the decompressed data. Empty lines and lines beginning with # are ignored. */
+#define MANIFEST_PATH "boot0.cfg"
+char default_manifest[]=
+	"opensbi opensbi.bin 0x40000000\n"
+	"dtb fdt 0x44000000\n"
+	"kernel Image 0x40200000\n";
 
-int ext2_load_file(struct ext2_sb *sb, char *filename, int filename_size, char *rootdir, uint32_t rootdir_size, uint32_t addr) {
-	printf("Loading %s at SDRAM_OFFSET(0x%x)... \n", filename, addr);
-	uint32_t inum=ext2_inode_num(sb, filename, filename_size, rootdir, rootdir_size); 
-	if(inum>0) {
-		char* ddest=(char*)(SDRAM_OFFSET(addr));
-		uint32_t fsize=ext2_read_inode_contents(sb, inum, 65535, (char*)(SDRAM_OFFSET(LOAD_SCRATCH)), ddest);
-		uint32_t nsectors=(fsize+1023)/1024;
-		printf("End at SDRAM_OFFSET(0x%x)\n", addr+1024*nsectors);
-		return(fsize);
+/* returns next whitespace-separated token of line *p (NUL-terminated), NULL if none */
+char *manifest_token(char **p) {
+	char *s=*p, *tok;
+	while(*s==' ' || *s=='\t') s++;
+	if(!*s) return(NULL);
+	tok=s;
+	while(*s && *s!=' ' && *s!='\t') s++;
+	if(*s) *s++=0;
+	*p=s;
+	return(tok);
+}
+
+/* parse an hexadecimal number, with an optional 0x prefix; returns 0 on success */
+int manifest_hex(char *s, phys_addr_t *val) {
+	phys_addr_t v=0;
+	if(s[0]=='0' && (s[1]=='x' || s[1]=='X')) s+=2;
+	if(!*s) return(-1);
+	for(; *s; s++) {
+		int d;
+		if(*s>='0' && *s<='9') d=*s-'0';
+		else if(*s>='a' && *s<='f') d=*s-'a'+10;
+		else if(*s>='A' && *s<='F') d=*s-'A'+10;
+		else return(-1);
+		v=(v << 4) | d;
+	}
+	*val=v;
+	return(0);
+}
+
+/* parse a SHA-256 digest of 64 hexadecimal digits; returns 0 on success */
+int manifest_digest(char *s, uint8_t *digest) {
+	char byte[3]={0, 0, 0};
+	phys_addr_t v;
+	if(strlen(s)!=64) return(-1);
+	for(int i=0; i<32; i++) {
+		byte[0]=s[2*i];
+		byte[1]=s[2*i+1];
+		if(manifest_hex(byte, &v)<0) return(-1);
+		digest[i]=v;
+	}
+	return(0);
+}
+
+/* ext2_load_file(), checking the file against SHA-256 digest sha if it is not NULL : its runs */
+/* are hashed as they come in, the file is hashed again once loaded only if they came out of order */
+int manifest_read(struct ext2_sb *sb, char *dirbuf, char *path, phys_addr_t addr, uint32_t max_size, uint8_t *sha) {
+	int size;
+#ifdef CFG_SUNXI_SHA256
+	uint8_t digest[32];
+	if(sha) {
+		sha256_starts(&ext2_hash.ctx);
+		ext2_hash.file=(char*)addr;
+	}
+#endif
+	size=ext2_load_file(sb, path, dirbuf, addr, max_size);
+#ifdef CFG_SUNXI_SHA256
+	ext2_hash.file=NULL;
+	if(sha && size>=0) {
+		if(ext2_hash.late) {
+			sha256_starts(&ext2_hash.ctx);
+			sha256_update(&ext2_hash.ctx, (uint8_t*)addr, size);
+		}
+		sha256_finish(&ext2_hash.ctx, digest);
+		if(memcmp(digest, sha, 32)) {
+			pr_err("%s : sha256 mismatch\n", path);
+			return(-1);
+		}
+	}
+#endif
+	return(size);
+}
+
+/* load one manifest entry (path at addr, with options opts); returns loaded size, -1 on error */
+int manifest_load(struct ext2_sb *sb, char *dirbuf, char *path, phys_addr_t addr, char *opts, int is_dtb) {
+	char *comp=NULL, *tok;
+	phys_addr_t crc=0;
+	int has_crc=0;
+	int size;
+	uint8_t *sha=NULL;
+#ifdef CFG_SUNXI_SHA256
+	uint8_t sha_digest[32];
+#endif
+
+	while((tok=manifest_token(&opts))) {
+		if(!strncmp(tok, "crc32=", 6)) {
+			if(manifest_hex(tok+6, &crc)<0) {
+				pr_err("bad hash %s\n", tok);
+				return(-1);
+			}
+			has_crc=1;
+#ifdef CFG_SUNXI_SHA256
+		} else if(!strncmp(tok, "sha256=", 7)) {
+			if(manifest_digest(tok+7, sha_digest)<0) {
+				pr_err("bad hash %s\n", tok);
+				return(-1);
+			}
+			sha=sha_digest;
+#endif
+		} else if(!strcmp(tok, "gz") || !strcmp(tok, "lz4") || !strcmp(tok, "lzma")) {
+			comp=tok;
+		} else {
+			pr_err("unknown option %s\n", tok);
+			return(-1);
+		}
+	}
+
+	uint32_t room;
+	if(comp) {
+		size=manifest_read(sb, dirbuf, path, SDRAM_OFFSET(LOAD_STAGING), ext2_room(SDRAM_OFFSET(LOAD_STAGING)), sha);
+		if(size<0) return(-1);
+		/* the compressed file is in the way until it is decompressed */
+		if(ext2_reserve(SDRAM_OFFSET(LOAD_STAGING), size)<0) return(-1);
+		room=ext2_room(addr);
+		ext2_nranges--;
 	} else {
-		printf("file not found\n");
+		room=ext2_room(addr);
+	}
+	if(is_dtb && room<SZ_1M) {
+		/* boot0 grows the FDT to 1M in place */
+		pr_err("no room for the FDT at 0x%x\n", addr);
 		return(-1);
 	}
+	if(!comp) {
+		size=manifest_read(sb, dirbuf, path, addr, room, sha);
+	} else {
+		int rc=-1;
+		ulong mark=malloc_mark();
+#ifdef CFG_SUNXI_GUNZIP
+		if(!strcmp(comp, "gz")) {
+			unsigned long len=size;
+			rc=gunzip((void*)addr, room, (unsigned char*)SDRAM_OFFSET(LOAD_STAGING), &len);
+			size=len;
+		}
+#endif
+#ifdef CFG_SUNXI_LZ4
+		if(!strcmp(comp, "lz4")) {
+			size_t len=room;
+			rc=ulz4fn((void*)SDRAM_OFFSET(LOAD_STAGING), size, (void*)addr, &len);
+			size=len;
+		}
+#endif
+#ifdef CFG_SUNXI_LZMA
+		if(!strcmp(comp, "lzma")) {
+			SizeT len=room;
+			rc=lzmaBuffToBuffDecompress((unsigned char*)addr, &len, (unsigned char*)SDRAM_OFFSET(LOAD_STAGING), size);
+			size=len;
+		}
+#endif
+		malloc_release(mark);
+		if(rc) {
+			pr_err("%s : %s decompression failed or not supported\n", path, comp);
+			return(-1);
+		}
+		pr_info("%s : decompressed to %d bytes\n", path, size);
+	}
+	if(size<0) return(-1);
+
+	if(has_crc) {
+		uint32_t c=crc32(0, (uint8_t*)addr, size);
+		if(c!=(uint32_t)crc) {
+			pr_err("%s : crc32 mismatch (%x, expected %x)\n", path, c, (uint32_t)crc);
+			return(-1);
+		}
+	}
+	if(ext2_reserve(addr, (is_dtb && size<SZ_1M) ? SZ_1M : size)<0) return(-1);
+	return(size);
+}
+
+/* load all entries of NUL-terminated manifest, filling the base addresses and cmdline */
+/* returns 0 on success, -1 on error */
+int manifest_run(struct ext2_sb *sb, char *dirbuf, char *manifest, 
+		phys_addr_t *uboot_base, phys_addr_t *opensbi_base, phys_addr_t *dtb_base, char **cmdline) {
+	char *line=manifest, *next;
+	for(int lnum=1; line && *line; line=next, lnum++) {
+		next=strchr(line, '\n');
+		if(next) *next++=0;
+		char *cr=strchr(line, '\r');
+		if(cr) *cr=0;
+
+		char *p=line;
+		char *kind=manifest_token(&p);
+		if(!kind || kind[0]=='#') continue;
+		if(!strcmp(kind, "cmdline")) {
+			while(*p==' ' || *p=='\t') p++;
+			*cmdline=p;
+			pr_info("cmdline : %s\n", p);
+			continue;
+		}
+
+		char *path=manifest_token(&p);
+		char *saddr=manifest_token(&p);
+		phys_addr_t addr;
+		if(!path || !saddr || manifest_hex(saddr, &addr)<0) {
+			pr_err("%s:%d : syntax error\n", MANIFEST_PATH, lnum);
+			return(-1);
+		}
+		phys_addr_t *base;
+		if(!strcmp(kind, "opensbi")) base=opensbi_base;
+		else if(!strcmp(kind, "dtb")) base=dtb_base;
+		else if(!strcmp(kind, "kernel")) base=uboot_base;
+		else if(!strcmp(kind, "file")) base=NULL;
+		else {
+			pr_err("%s:%d : unknown kind %s\n", MANIFEST_PATH, lnum, kind);
+			return(-1);
+		}
+		if(manifest_load(sb, dirbuf, path, addr, p, base==dtb_base)<0)
+			return(-1);
+		char *fname=strrchr(path, '/');
+		timeline_mark(fname ? fname+1 : path);
+		if(base) *base=addr;
+	}
+	return(0);
 }
 
 /* main function */
@@ -300,28 +1085,27 @@ int load_ext2(phys_addr_t *uboot_base, phys_addr_t *optee_base, \
 	char *mbr;
 	mbr=(char*)SDRAM_OFFSET(LOAD_SCRATCH2);
 	char *buf;
-	buf=(char*)SDRAM_OFFSET(LOAD_SCRATCH2+1024);
-	char *rootdir;
-	rootdir=(char*)SDRAM_OFFSET(LOAD_SCRATCH2+2048);
-	//printf("addr rootdir=%lx\n",rootdir);
+	buf=(char*)SDRAM_OFFSET(LOAD_SCRATCH2+512);
+	char *dirbuf;
 	struct ext2_sb sbb;
 	struct ext2_sb *sb=&sbb; 
 
-	//printf("addr &rc=%lx &part_num=%lx mbr=%lx buf=%lx rootdir=%lx",&rc,&part_num,mbr,buf,rootdir);
+	//printf("addr &rc=%lx &part_num=%lx mbr=%lx buf=%lx",&rc,&part_num,mbr,buf);
 
 	*optee_base=*monitor_base=*rtos_base=0;
 	*cmdline=NULL;
 
 	if((rc=sunxi_mmc_init(SDC_NO, 4, BT0_head.prvt_head.storage_gpio, 16))<0)
 		return(rc);
+	timeline_mark("mmc");
 
 	/* fetch MBR */
 	if((rc=mmc_bread(SDC_NO, 0, 1, mbr))<0) {
-		printf("Error reading MBR\n");
+		pr_err("Error reading MBR\n");
 		return(rc);
 	}
 	if(mbr[510]!=0x55 || mbr[511]!=0xAA) {
-		printf("Invalid MBR signature\n");
+		pr_err("Invalid MBR signature\n");
 		return(-1);
 	}
 
@@ -331,51 +1115,40 @@ int load_ext2(phys_addr_t *uboot_base, phys_addr_t *optee_base, \
 			break;
 	}
 	if(part_num==3) {
-		printf("No suitable partition found\n");
+		pr_err("No suitable partition found\n");
 		return(-1);
 	}
 
-	/* read root directory (inode 2) */
-	uint32_t rootdir_size=ext2_read_inode_contents(sb, 2, 1, (char*)(SDRAM_OFFSET(LOAD_SCRATCH)), rootdir); 
+	/* directory contents, for path lookups */
+	dirbuf=(char*)SDRAM_OFFSET(LOAD_SCRATCH+LOAD_SCRATCH_SIZE(sb));
 
-/*
-	printf("rootdir size=%d\n", rootdir_size);
-	for(int i=0;i<rootdir_size;i++) {
-		printf("%x ", rootdir[i]);
-	}
-*/
-
-/*
-	uint32_t inum=ext2_inode_num(sb, "hello.bin", 9, rootdir, rootdir_size); 
-	if(inum>0) {
-		char* ddest=(char*)(SDRAM_OFFSET(0x01000000));
-		uint32_t fsize=ext2_read_inode_contents(sb, inum, 20000, (char*)(SDRAM_OFFSET(LOAD_SCRATCH)), ddest);
-		uint32_t toffs=15*1048576-4;
-		if(fsize);
-		printf("read : %x %x %x %x\n", ddest[toffs], ddest[toffs+1], ddest[toffs+2], ddest[toffs+3]);
+	/* read the manifest, or use the built-in one */
+	char *manifest=(char*)SDRAM_OFFSET(LOAD_MANIFEST);
+	rc=ext2_namei(sb, MANIFEST_PATH, (char*)SDRAM_OFFSET(LOAD_SCRATCH), dirbuf);
+	if(rc>0) {
+		uint32_t *bmap=(uint32_t*)SDRAM_OFFSET(LOAD_SCRATCH+2*512*sb->block_size);
+		uint32_t flags;
+		uint32_t msize=ext2_read_inode_block_map(sb, rc, dirbuf, bmap, &flags);
+		int nblocks=(msize+512*sb->block_size-1)/(512*sb->block_size);
+		if(msize>=MANIFEST_MAX_SIZE) {
+			pr_err("%s larger than %d bytes\n", MANIFEST_PATH, MANIFEST_MAX_SIZE-1);
+			return(-1);
+		}
+		/* read whole blocks into dirbuf, then keep the manifest out of its way */
+		if(ext2_read_map_contents(sb, bmap, flags, msize, nblocks, (char*)SDRAM_OFFSET(LOAD_SCRATCH), dirbuf)!=nblocks)
+			return(-1);
+		memcpy(manifest, dirbuf, msize);
+		manifest[msize]=0;
 	} else {
-		printf("file not found\n");
+		pr_info("no %s, using default manifest\n", MANIFEST_PATH);
+		memcpy(manifest, default_manifest, sizeof(default_manifest));
 	}
-*/
-
-#define SBI_OFF 0
-#define FDT_OFF 0x4000000
-#define IMG_OFF 0x200000  // 0xa000000
-//#define       0x1010000
+	timeline_mark("manifest");
 
-	ext2_load_file(sb, "opensbi.bin", 11, rootdir, rootdir_size, SBI_OFF);
-	ext2_load_file(sb, "fdt", 3, rootdir, rootdir_size, FDT_OFF);
-	int imgsz=ext2_load_file(sb, "Image", 5, rootdir, rootdir_size, IMG_OFF);
-	if(imgsz);
-	printf("begin image:\n");
-	for(int i=0;i<32;i++) printf("%x ",*(char*)(SDRAM_OFFSET(IMG_OFF+i)));
-	printf("end image:\n");
-	for(int i=imgsz-32;i<imgsz;i++) printf("%x ",*(char*)(SDRAM_OFFSET(IMG_OFF+i)));
-
-
-	*uboot_base=SDRAM_OFFSET(IMG_OFF);
-	*opensbi_base=SDRAM_OFFSET(SBI_OFF); //SDRAM_OFFSET(IMG_OFF); //SDRAM_OFFSET(SBI_OFF);
-	*dtb_base=SDRAM_OFFSET(FDT_OFF);
+	*uboot_base=*opensbi_base=*dtb_base=0;
+	ext2_nranges=LOAD_RANGES_BOOT0;
+	if(manifest_run(sb, dirbuf, manifest, uboot_base, opensbi_base, dtb_base, cmdline)<0)
+		return(-1);
 
 /*
 	volatile char *iob=sunxi_get_iobase(SUNXI_UART0_BASE);
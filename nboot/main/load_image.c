@@ -7,6 +7,7 @@
  */
 
 #include <common.h>
+#include <pmu.h>
 #include <spare_head.h>
 #include <nand_boot0.h>
 #include <private_toc.h>
@@ -17,17 +18,416 @@
 #include <u-boot/zlib.h>
 #include <lzma/LzmaTools.h>
 #include <u-boot/lz4.h>
+#include <u-boot/sha256.h>
 
 extern const boot0_file_head_t  BT0_head;
 
+/* may return with the copy still on the DMA, see dma_memcpy_wait() */
 int toc1_flash_read(u32 start_sector, u32 blkcnt, void *buff)
 {
 	void __iomem *addr = sunxi_get_iobase(CONFIG_BOOTPKG_BASE + 512 * start_sector);
-	memcpy(buff, (addr), 512 * blkcnt);
+
+	if (dma_memcpy(buff, addr, 512 * blkcnt))
+		memcpy(buff, (addr), 512 * blkcnt);
 
 	return blkcnt;
 }
 
+#ifdef CFG_SUNXI_SHA256
+/* item being hashed as it comes in, data_len bytes of it are left */
+static sha256_context toc1_sha;
+static u32 toc1_sha_left;
+static int toc1_items_hashed;
+
+static int toc1_item_has_sha256(struct sbrom_toc1_item_info *toc1_item)
+{
+	int i;
+
+	for (i = 0; i < SHA256_SUM_LEN; i++)
+		if (toc1_item->sha256[i])
+			return 1;
+
+	return 0;
+}
+
+/* check the item against its sha256, hashing data first unless it was hashed as it was read */
+static int toc1_sha256_verify(struct sbrom_toc1_item_info *toc1_item, const void *data)
+{
+	u8 digest[SHA256_SUM_LEN];
+
+	if (data) {
+		sha256_starts(&toc1_sha);
+		sha256_update(&toc1_sha, data, toc1_item->data_len);
+	}
+	toc1_sha_left = 0;
+	sha256_finish(&toc1_sha, digest);
+	if (memcmp(digest, toc1_item->sha256, SHA256_SUM_LEN)) {
+		pr_err("%s: sha256 mismatch\n", toc1_item->name);
+		return -1;
+	}
+
+	return 0;
+}
+#endif
+
+/*
+ * add_sum_update() for the package readers, which call it chunk by chunk as
+ * the data comes in: the item being loaded is hashed on the way
+ */
+u32 toc1_sum_update(u32 sum, const void *buf, u32 size)
+{
+#ifdef CFG_SUNXI_SHA256
+	if (toc1_sha_left) {
+		u32 n = min(size, toc1_sha_left);
+
+		sha256_update(&toc1_sha, buf, n);
+		toc1_sha_left -= n;
+	}
+#endif
+	return add_sum_update(sum, buf, size);
+}
+
+/* items are at their run_addr already, load_image() only decompresses */
+static int toc1_items_placed;
+
+/* the boot0 work area holds the heap and the mmc descriptor ring */
+static int toc1_in_work_area(phys_addr_t addr, u32 len)
+{
+	return addr < CONFIG_BOOT0_WORK_BASE + CONFIG_BOOT0_WORK_SIZE &&
+	       addr + len > CONFIG_BOOT0_WORK_BASE;
+}
+
+/* the package, read whole, and the items must keep out of the work area */
+static int toc1_check_layout(struct sbrom_toc1_head_info *toc1_head)
+{
+	struct sbrom_toc1_item_info *toc1_item;
+	u32 i, len;
+
+	if (toc1_head->valid_len > CONFIG_BOOTPKG_MAX_SIZE) {
+		pr_err("error:toc1 too large.\n");
+		return -1;
+	}
+	toc1_item = (struct sbrom_toc1_item_info *)(toc1_head + 1);
+	for (i = 0; i < toc1_head->items_nr; i++, toc1_item++) {
+		len = toc1_item->comp == TOC1_ITEM_COMP_NONE ?
+			toc1_item->data_len : toc1_item->raw_len;
+		if (toc1_item->run_addr && toc1_in_work_area(toc1_item->run_addr, len)) {
+			pr_err("%s overlaps the boot0 work area\n", toc1_item->name);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+#ifdef CFG_TOC1_DIRECT_LOAD
+
+/*
+ * read and sum the package sectors [start, end) to where the package would
+ * be at CONFIG_BOOTPKG_BASE
+ */
+static int toc1_read_staged(int (*read_sum)(u32 sector, void *dst, uint size, u32 *sum),
+			    u32 start, u32 end, u32 valid_len, u32 *sum)
+{
+	u8 *buff = (u8 *)sunxi_get_iobase(CONFIG_BOOTPKG_BASE);
+
+	if (start >= end || start * 512 >= valid_len)
+		return 0;
+
+	return read_sum(start, buff + start * 512, min((end - start) * 512, valid_len - start * 512), sum);
+}
+
+/*
+ * load the package with each item read straight from storage to its
+ * run_addr instead of through CONFIG_BOOTPKG_BASE. read_sum(sector, dst,
+ * size, sum) reads size bytes from a sector of the package and adds them to
+ * *sum. Everything else, the head and item table, padding and compressed
+ * items, goes where it is in a package read whole, for load_image().
+ * Returns 0 if the package checks, -1 on error and 1 if the items are not
+ * laid out in order on sector boundaries, when it has to be read whole.
+ */
+int load_toc1_direct(int (*read_sum)(u32 sector, void *dst, uint size, u32 *sum))
+{
+	u8 *buff = (u8 *)sunxi_get_iobase(CONFIG_BOOTPKG_BASE);
+	struct sbrom_toc1_head_info *toc1_head = (struct sbrom_toc1_head_info *)buff;
+	struct sbrom_toc1_item_info *toc1_item;
+	u32 sum = 0, src_sum, valid_len, head_len, pos, start, n, i;
+	phys_addr_t run_addr;
+
+	toc1_items_placed = 0;
+#ifdef CFG_SUNXI_SHA256
+	toc1_items_hashed = 0;
+	toc1_sha_left = 0;
+#endif
+	/* the head is summed again below, once add_sum is stamped */
+	if (read_sum(0, buff, 512, &sum))
+		return -1;
+	if (toc1_head->magic != TOC_MAIN_INFO_MAGIC) {
+		pr_err("error:bad magic.\n");
+		return -1;
+	}
+	valid_len = toc1_head->valid_len;
+	head_len  = sizeof(struct sbrom_toc1_head_info) +
+		   toc1_head->items_nr * sizeof(struct sbrom_toc1_item_info);
+	if (head_len > valid_len || head_len > 64 * 512) {
+		pr_err("error:bad toc1 head.\n");
+		return -1;
+	}
+	pos = (head_len + 511) / 512;
+	if (toc1_read_staged(read_sum, 1, pos, valid_len, &sum) || toc1_check_layout(toc1_head))
+		return -1;
+
+	/* sanity check the layout before anything is overwritten */
+	toc1_item = (struct sbrom_toc1_item_info *)(buff + sizeof(struct sbrom_toc1_head_info));
+	for (i = 0, start = pos; i < toc1_head->items_nr; i++, toc1_item++) {
+		run_addr = toc1_item->run_addr;
+		n = (toc1_item->data_len + 511) / 512;
+		if ((toc1_item->data_offset & 511) || toc1_item->data_offset / 512 < start ||
+		    toc1_item->data_offset + toc1_item->data_len > valid_len)
+			return 1;
+		if (run_addr && toc1_item->comp == TOC1_ITEM_COMP_NONE &&
+		    run_addr < CONFIG_BOOTPKG_BASE + valid_len &&
+		    run_addr + n * 512 > CONFIG_BOOTPKG_BASE)
+			return 1;
+		start = toc1_item->data_offset / 512 + n;
+	}
+
+	/* same sum as verify_addsum(), computed as the package comes in */
+	src_sum = toc1_head->add_sum;
+	toc1_head->add_sum = STAMP_VALUE;
+	sum = add_sum_update(0, buff, min(pos * 512, valid_len));
+	toc1_head->add_sum = src_sum;
+
+	toc1_item = (struct sbrom_toc1_item_info *)(buff + sizeof(struct sbrom_toc1_head_info));
+	for (i = 0; i < toc1_head->items_nr; i++, toc1_item++) {
+		start = toc1_item->data_offset / 512;
+		n = (toc1_item->data_len + 511) / 512;
+		if (toc1_read_staged(read_sum, pos, start, valid_len, &sum))
+			return -1;
+#ifdef CFG_SUNXI_SHA256
+		if (toc1_item_has_sha256(toc1_item)) {
+			sha256_starts(&toc1_sha);
+			toc1_sha_left = toc1_item->data_len;
+		}
+#endif
+		if (toc1_item->run_addr && toc1_item->comp == TOC1_ITEM_COMP_NONE) {
+			if (read_sum(start, (void *)sunxi_get_iobase(toc1_item->run_addr),
+				     min(n * 512, valid_len - start * 512), &sum))
+				return -1;
+		} else if (toc1_read_staged(read_sum, start, start + n, valid_len, &sum)) {
+			return -1;
+		}
+#ifdef CFG_SUNXI_SHA256
+		if (toc1_item_has_sha256(toc1_item) && toc1_sha256_verify(toc1_item, NULL))
+			return -1;
+#endif
+		timeline_mark(toc1_item->name);
+		pos = start + n;
+	}
+	if (toc1_read_staged(read_sum, pos, (valid_len + 511) / 512, valid_len, &sum))
+		return -1;
+
+	if (sum != src_sum) {
+		pr_err("error:bad checksum.\n");
+		return -1;
+	}
+	toc1_items_placed = 1;
+#ifdef CFG_SUNXI_SHA256
+	toc1_items_hashed = 1;
+#endif
+
+	return 0;
+}
+#endif
+
+#ifdef CFG_SUNXI_SHA256
+#define TOC1_SHA_CHUNK	(16 << 10)	/* hashed while it is still in the dcache */
+#endif
+
+/*
+ * sum the item at src, copying it to dst on the CPU unless dst is NULL or
+ * the DMA takes it, when it is summed while the DMA moves it. An item with
+ * a sha256 is hashed chunk by chunk as it is summed, and checked.
+ */
+static int toc1_item_sum(struct sbrom_toc1_item_info *toc1_item, const u8 *src, u8 *dst, u32 *sum)
+{
+	u32 len = toc1_item->data_len;
+
+	if (dst && !dma_memcpy(dst, src, len))
+		dst = NULL;
+#ifdef CFG_SUNXI_SHA256
+	if (toc1_item_has_sha256(toc1_item)) {
+		u32 off, n;
+
+		sha256_starts(&toc1_sha);
+		for (off = 0; off < len; off += n) {
+			n = min(len - off, (u32)TOC1_SHA_CHUNK);
+			*sum = dst ? memcpy_addsum(dst + off, src + off, n, *sum) :
+				     add_sum_update(*sum, src + off, n);
+			sha256_update(&toc1_sha, src + off, n);
+		}
+		return toc1_sha256_verify(toc1_item, NULL);
+	}
+#endif
+	*sum = dst ? memcpy_addsum(dst, src, len, *sum) : add_sum_update(*sum, src, len);
+
+	return 0;
+}
+
+/*
+ * check the package read whole at CONFIG_BOOTPKG_BASE, moving its
+ * uncompressed items to their run_addr with memcpy_addsum() as it is summed
+ * and hashing the items that have a sha256 on the way, so that each byte is
+ * read once. Items are only moved if they are in order and their run_addr
+ * is clear of the package, else load_image() copies them; they are only
+ * hashed here if they are in order, else load_image() hashes them. Returns
+ * 0 if the package checks, -1 if not.
+ */
+int load_toc1_staged(void)
+{
+	u8 *buff = (u8 *)sunxi_get_iobase(CONFIG_BOOTPKG_BASE);
+	struct sbrom_toc1_head_info *toc1_head = (struct sbrom_toc1_head_info *)buff;
+	struct sbrom_toc1_item_info *toc1_item;
+	u32 sum, src_sum, valid_len, pos, i;
+	int ordered = 1, place = 1, bad = 0, move;
+
+	toc1_items_placed = 0;
+#ifdef CFG_SUNXI_SHA256
+	toc1_items_hashed = 0;
+	toc1_sha_left = 0;
+#endif
+	valid_len = toc1_head->valid_len & ~3;
+	if (sizeof(struct sbrom_toc1_head_info) +
+	    toc1_head->items_nr * sizeof(struct sbrom_toc1_item_info) > valid_len) {
+		pr_err("error:bad toc1 head.\n");
+		return -1;
+	}
+	if (toc1_check_layout(toc1_head))
+		return -1;
+
+	toc1_item = (struct sbrom_toc1_item_info *)(buff + sizeof(struct sbrom_toc1_head_info));
+	for (i = 0, pos = 0; i < toc1_head->items_nr; i++, toc1_item++) {
+		if ((toc1_item->data_offset & 3) || toc1_item->data_offset < pos ||
+		    toc1_item->data_offset + toc1_item->data_len > valid_len)
+			ordered = place = 0;
+		if (toc1_item->run_addr && toc1_item->comp == TOC1_ITEM_COMP_NONE &&
+		    toc1_item->run_addr < CONFIG_BOOTPKG_BASE + valid_len &&
+		    toc1_item->run_addr + toc1_item->data_len > CONFIG_BOOTPKG_BASE)
+			place = 0;
+		pos = toc1_item->data_offset + toc1_item->data_len;
+	}
+
+	src_sum = toc1_head->add_sum;
+	toc1_head->add_sum = STAMP_VALUE;
+	if (!ordered) {
+		sum = add_sum_update(0, buff, valid_len);
+	} else {
+		/* the item table is summed with the gap before the first item */
+		toc1_item = (struct sbrom_toc1_item_info *)(buff + sizeof(struct sbrom_toc1_head_info));
+		for (i = 0, pos = 0, sum = 0; i < toc1_head->items_nr; i++, toc1_item++) {
+			move = place && toc1_item->run_addr && toc1_item->comp == TOC1_ITEM_COMP_NONE;
+#ifdef CFG_SUNXI_SHA256
+			if (!move && !toc1_item_has_sha256(toc1_item))
+				continue;
+#else
+			if (!move)
+				continue;
+#endif
+			sum = add_sum_update(sum, buff + pos, toc1_item->data_offset - pos);
+			if (toc1_item_sum(toc1_item, buff + toc1_item->data_offset,
+					  move ? (u8 *)sunxi_get_iobase(toc1_item->run_addr) : NULL,
+					  &sum))
+				bad = 1;
+			if (move)
+				timeline_mark(toc1_item->name);
+			/* a partial last word is summed with what follows */
+			pos = toc1_item->data_offset + (toc1_item->data_len & ~3);
+		}
+		sum = add_sum_update(sum, buff + pos, valid_len - pos);
+		dma_memcpy_wait();
+	}
+	toc1_head->add_sum = src_sum;
+
+	if (sum != src_sum) {
+		pr_err("error:bad checksum.\n");
+		return -1;
+	}
+	if (bad)
+		return -1;
+	toc1_items_placed = place;
+#ifdef CFG_SUNXI_SHA256
+	toc1_items_hashed = ordered;
+#endif
+
+	return 0;
+}
+
+/* decompress an item from where it is in the package at CONFIG_BOOTPKG_BASE */
+static int toc1_item_decompress(struct sbrom_toc1_item_info *toc1_item, phys_addr_t image_base)
+{
+	__maybe_unused u8 *src = (u8 *)sunxi_get_iobase(CONFIG_BOOTPKG_BASE + toc1_item->data_offset);
+	__maybe_unused void *dst = (void *)sunxi_get_iobase(image_base);
+	PMU_SCOPE(scope, "toc1_decompress");
+	int ret = -1;
+	u32 len = 0;
+	ulong mark;
+
+	if (image_base < CONFIG_BOOTPKG_BASE + toc1_item->data_offset + toc1_item->data_len &&
+	    image_base + toc1_item->raw_len > CONFIG_BOOTPKG_BASE + toc1_item->data_offset) {
+		pr_err("%s overlaps its compressed data\n", toc1_item->name);
+		return -1;
+	}
+	if (toc1_in_work_area(image_base, toc1_item->raw_len)) {
+		pr_err("%s overlaps the boot0 work area\n", toc1_item->name);
+		return -1;
+	}
+	mark = malloc_mark();
+	pmu_begin(&scope);
+
+	switch (toc1_item->comp) {
+#ifdef CFG_SUNXI_GUNZIP
+	case TOC1_ITEM_COMP_GZIP: {
+		unsigned long n = toc1_item->data_len;
+
+		ret = gunzip(dst, toc1_item->raw_len, src, &n);
+		len = n;
+		break;
+	}
+#endif
+#ifdef CFG_SUNXI_LZ4
+	case TOC1_ITEM_COMP_LZ4: {
+		size_t n = toc1_item->raw_len;
+
+		ret = ulz4fn(src, toc1_item->data_len, dst, &n);
+		len = n;
+		break;
+	}
+#endif
+#ifdef CFG_SUNXI_LZMA
+	case TOC1_ITEM_COMP_LZMA: {
+		SizeT n = toc1_item->raw_len;
+
+		ret = lzmaBuffToBuffDecompress(dst, &n, src, toc1_item->data_len);
+		len = n;
+		break;
+	}
+#endif
+	default:
+		pr_err("%s: compression %d not supported\n", toc1_item->name, toc1_item->comp);
+		return -1;
+	}
+	pmu_end(&scope);
+	malloc_release(mark);
+
+	if (ret || len != toc1_item->raw_len) {
+		pr_err("%s: decompression failed\n", toc1_item->name);
+		return -1;
+	}
+	pr_debug("%s: decompressed %d to %d bytes\n", toc1_item->name, toc1_item->data_len, len);
+
+	return 0;
+}
+
 int load_image(phys_addr_t *uboot_base, phys_addr_t *optee_base, \
 		phys_addr_t *monitor_base, phys_addr_t *rtos_base, phys_addr_t *opensbi_base, phys_addr_t *dtb_base)
 {
@@ -45,39 +445,33 @@ int load_image(phys_addr_t *uboot_base, phys_addr_t *optee_base, \
 	toc1_head = (struct sbrom_toc1_head_info *)bootpkg_base;
 	item_head = (struct sbrom_toc1_item_info *)(bootpkg_base + sizeof(struct sbrom_toc1_head_info));
 
-#ifdef BOOT_DEBUG
-	printf("*******************TOC1 Head Message*************************\n");
-	printf("Toc_name          = %s\n",   toc1_head->name);
-	printf("Toc_magic         = 0x%x\n", toc1_head->magic);
-	printf("Toc_add_sum       = 0x%x\n", toc1_head->add_sum);
+	pr_debug("*******************TOC1 Head Message*************************\n");
+	pr_debug("Toc_name          = %s\n",   toc1_head->name);
+	pr_debug("Toc_magic         = 0x%x\n", toc1_head->magic);
+	pr_debug("Toc_add_sum       = 0x%x\n", toc1_head->add_sum);
 
-	printf("Toc_serial_num    = 0x%x\n", toc1_head->serial_num);
-	printf("Toc_status        = 0x%x\n", toc1_head->status);
+	pr_debug("Toc_serial_num    = 0x%x\n", toc1_head->serial_num);
+	pr_debug("Toc_status        = 0x%x\n", toc1_head->status);
 
-	printf("Toc_items_nr      = 0x%x\n", toc1_head->items_nr);
-	printf("Toc_valid_len     = 0x%x\n", toc1_head->valid_len);
-	printf("TOC_MAIN_END      = 0x%x\n", toc1_head->end);
-	printf("*************************************************************\n");
-#endif
+	pr_debug("Toc_items_nr      = 0x%x\n", toc1_head->items_nr);
+	pr_debug("Toc_valid_len     = 0x%x\n", toc1_head->valid_len);
+	pr_debug("TOC_MAIN_END      = 0x%x\n", toc1_head->end);
+	pr_debug("*************************************************************\n");
 	//init
 	toc1_item = item_head;
 	for(i=0;i<toc1_head->items_nr;i++,toc1_item++)
 	{
-#ifdef BOOT_DEBUG
-		printf("*******************TOC1 Item Message*************************\n");
-		printf("Entry_name        = %s\n",   toc1_item->name);
-		printf("Entry_data_offset = 0x%x\n", toc1_item->data_offset);
-		printf("Entry_data_len    = 0x%x\n", toc1_item->data_len);
-
-		printf("encrypt           = 0x%x\n", toc1_item->encrypt);
-		printf("Entry_type        = 0x%x\n", toc1_item->type);
-		printf("run_addr          = 0x%x\n", toc1_item->run_addr);
-		printf("index             = 0x%x\n", toc1_item->index);
-		printf("Entry_end         = 0x%x\n", toc1_item->end);
-		printf("*************************************************************\n");
-#else
-		printf("Entry_name        = %s\n",   toc1_item->name);
-#endif
+		pr_debug("*******************TOC1 Item Message*************************\n");
+		pr_info("Entry_name        = %s\n",   toc1_item->name);
+		pr_debug("Entry_data_offset = 0x%x\n", toc1_item->data_offset);
+		pr_debug("Entry_data_len    = 0x%x\n", toc1_item->data_len);
+
+		pr_debug("encrypt           = 0x%x\n", toc1_item->encrypt);
+		pr_debug("Entry_type        = 0x%x\n", toc1_item->type);
+		pr_debug("run_addr          = 0x%x\n", toc1_item->run_addr);
+		pr_debug("index             = 0x%x\n", toc1_item->index);
+		pr_debug("Entry_end         = 0x%x\n", toc1_item->end);
+		pr_debug("*************************************************************\n");
 
 		image_base = toc1_item->run_addr;
 		if (strncmp(toc1_item->name, ITEM_UBOOT_NAME, sizeof(ITEM_UBOOT_NAME)) == 0) {
@@ -93,8 +487,23 @@ int load_image(phys_addr_t *uboot_base, phys_addr_t *optee_base, \
 		} else if (strncmp(toc1_item->name, ITEM_DTB_NAME, sizeof(ITEM_DTB_NAME)) == 0) {
 			*dtb_base = image_base;
 		}
+#ifdef CFG_SUNXI_SHA256
+		if (!toc1_items_hashed && toc1_item_has_sha256(toc1_item) &&
+		    toc1_sha256_verify(toc1_item, bootpkg_base + toc1_item->data_offset))
+			return -1;
+#endif
+		if (toc1_item->comp != TOC1_ITEM_COMP_NONE) {
+			if (toc1_item_decompress(toc1_item, image_base))
+				return -1;
+			timeline_mark(toc1_item->name);
+			continue;
+		}
+		if (toc1_items_placed)
+			continue;
 		toc1_flash_read(toc1_item->data_offset/512, (toc1_item->data_len+511)/512, (void *)image_base);
+		timeline_mark(toc1_item->name);
 	}
+	dma_memcpy_wait();
 
 	return 0;
 }
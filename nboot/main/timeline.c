@@ -0,0 +1,96 @@
+/*
+ * SPDX-License-Identifier:	GPL-2.0+
+ *
+ * boot timeline: get_arch_counter() stamps taken as each boot0 phase ends,
+ * handed to the next stage in /chosen and at CONFIG_BOOT0_TIMELINE_BASE.
+ * tools/boot0_timeline.py renders either.
+ */
+
+#include <common.h>
+#include <libfdt.h>
+#include <private_boot0.h>
+
+static struct boot0_timeline timeline;
+/* slot of the "jump" stamp in /chosen/boot0,timings, -1 if not there */
+static int timeline_fdt_jump = -1;
+
+void timeline_mark(const char *name)
+{
+	struct boot0_timeline_entry *e;
+
+	/* the last slot is kept for the jump */
+	if (timeline.count >= BOOT0_TIMELINE_MAX - 1)
+		return;
+	e = &timeline.entry[timeline.count++];
+	e->stamp = get_arch_counter();
+	strncpy(e->name, name, sizeof(e->name) - 1);
+}
+
+/*
+ * add boot0,timer-frequency, boot0,timing-names and boot0,timings to
+ * /chosen, the stamps as pairs of cells. The jump is given its name and
+ * a zero stamp here, timeline_publish() fills it in once the DTB is packed.
+ */
+void timeline_fdt(void *fdt)
+{
+	u32 *cells;
+	int offs, i, n = timeline.count;
+
+	offs = fdt_path_offset(fdt, "/chosen");
+	if (offs < 0)
+		offs = fdt_add_subnode(fdt, 0, "chosen");
+	if (offs < 0)
+		goto fail;
+	if (fdt_setprop_u32(fdt, offs, "boot0,timer-frequency", BOOT0_TIMELINE_FREQ) < 0)
+		goto fail;
+	if (fdt_setprop(fdt, offs, "boot0,timing-names", NULL, 0) < 0)
+		goto fail;
+	for (i = 0; i < n; i++)
+		if (fdt_appendprop_string(fdt, offs, "boot0,timing-names",
+					  timeline.entry[i].name) < 0)
+			goto fail;
+	if (fdt_appendprop_string(fdt, offs, "boot0,timing-names", "jump") < 0)
+		goto fail;
+	if (fdt_setprop_placeholder(fdt, offs, "boot0,timings",
+				    (n + 1) * 2 * sizeof(u32), (void **)&cells) < 0)
+		goto fail;
+	for (i = 0; i < n; i++) {
+		cells[2 * i]     = cpu_to_fdt32(timeline.entry[i].stamp >> 32);
+		cells[2 * i + 1] = cpu_to_fdt32(timeline.entry[i].stamp);
+	}
+	cells[2 * n] = cells[2 * n + 1] = 0;
+	timeline_fdt_jump = n;
+	return;
+
+fail:
+	pr_warn("timeline: no room in DTB\n");
+}
+
+/*
+ * stamp the jump and hand the timeline over: to CONFIG_BOOT0_TIMELINE_BASE,
+ * and to the DTB at fdt if timeline_fdt() was run on it
+ */
+void timeline_publish(void *fdt)
+{
+	struct boot0_timeline_entry *e = &timeline.entry[timeline.count++];
+	u32 cells[2];
+	int offs;
+
+	e->stamp = get_arch_counter();
+	strcpy(e->name, "jump");
+	timeline.magic = BOOT0_TIMELINE_MAGIC;
+	timeline.freq = BOOT0_TIMELINE_FREQ;
+	memcpy((void *)CONFIG_BOOT0_TIMELINE_BASE, &timeline, sizeof(timeline));
+
+	if (!fdt || timeline_fdt_jump < 0)
+		return;
+	offs = fdt_path_offset(fdt, "/chosen");
+	if (offs < 0)
+		return;
+	cells[0] = cpu_to_fdt32(e->stamp >> 32);
+	cells[1] = cpu_to_fdt32(e->stamp);
+	fdt_setprop_inplace_namelen_partial(fdt, offs, "boot0,timings",
+					    strlen("boot0,timings"),
+					    timeline_fdt_jump * sizeof(cells),
+					    cells, sizeof(cells));
+}
@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: GPL-2.0+
+#
+# Decode the binary log of a boot0 built with CFG_BOOT0_BINLOG=y
+# (struct boot0_blog_rec, include/private_boot0.h) back to printf() text.
+#
+#   boot0_blog.py boot0.elf blog.bin
+#
+# blog.bin is a dump of CONFIG_BOOT0_BLOG_BASE, header included, eg. from
+# u-boot md or /dev/mem. Format strings are read from boot0.elf, so it has
+# to be the one that ran.
+
+import argparse
+import re
+import struct
+import sys
+
+BOOT0_BLOG_MAGIC = 0x4e494242
+FREQ = 24000000
+# a conversion as _vprintf() parses it, and those it takes an argument for:
+# blog_record() stores nothing for the others
+CONV = re.compile(r'%(-?)(0?)(\d*)(l?)(.)', re.S)
+ARG_CONV = 'udxcsp'
+
+
+class Image:
+    """the allocated sections of an ELF64, to read strings from"""
+
+    def __init__(self, data):
+        if data[:4] != b'\x7fELF' or data[4] != 2:
+            sys.exit('not an ELF64 file')
+        shoff, = struct.unpack_from('<Q', data, 0x28)
+        shentsize, shnum = struct.unpack_from('<HH', data, 0x3a)
+        self.data = data
+        self.sections = []
+        for i in range(shnum):
+            sh = struct.unpack_from('<IIQQQQIIQQ', data, shoff + i * shentsize)
+            if sh[1] == 1 and sh[2] & 2:  # SHT_PROGBITS, SHF_ALLOC
+                self.sections.append((sh[3], sh[5], sh[4]))
+
+    def string(self, addr):
+        for base, size, off in self.sections:
+            if base <= addr < base + size:
+                start = off + addr - base
+                return self.data[start:self.data.index(b'\0', start)].decode(errors='replace')
+        return None
+
+
+def render(fmt, args):
+    """format as common/printf.c _vprintf() would"""
+    out = []
+    pos = 0
+    for m in CONV.finditer(fmt):
+        out.append(fmt[pos:m.start()])
+        pos = m.end()
+        _, lz, width, islong, ch = m.groups()
+        if ch == '%':
+            s = '%'
+        elif ch not in ARG_CONV:
+            s = ''
+        elif not args:
+            s = '<?>'
+        elif ch == 's':
+            s = args.pop(0)
+        else:
+            v = args.pop(0)
+            if ch == 'd':
+                bits = 64 if islong else 32
+                v &= (1 << bits) - 1
+                s = str(v - (1 << bits) if v >> (bits - 1) else v)
+            elif ch == 'u':
+                s = str(v if islong else v & 0xffffffff)
+            elif ch == 'x':
+                s = '%x' % (v if islong else v & 0xffffffff)
+            elif ch == 'c':
+                s = chr(v & 0xff)
+            else:
+                s = '%x' % v
+                alnum = re.match(r'[0-9A-Za-z]*', fmt[pos:])
+                pos += alnum.end()
+        out.append(s.rjust(int(width or 0), '0' if lz else ' '))
+    out.append(fmt[pos:])
+    return ''.join(out)
+
+
+def decode(image, data):
+    magic, length, _, dropped = struct.unpack_from('<IIII', data)
+    if magic != BOOT0_BLOG_MAGIC:
+        sys.exit('no boot0 binary log (magic 0x%08x)' % magic)
+    pos, end = 16, 16 + length
+    while pos < end:
+        fmt_addr, size, stamp = struct.unpack_from('<IIQ', data, pos)
+        fmt = image.string(fmt_addr)
+        if fmt is None:
+            sys.exit('format 0x%x at +0x%x is not in the image' % (fmt_addr, pos))
+        args = []
+        p = pos + 16
+        for m in CONV.finditer(fmt):
+            ch = m.group(5)
+            if ch not in ARG_CONV or p >= pos + size:
+                continue
+            v, = struct.unpack_from('<Q', data, p)
+            p += 8
+            if ch == 's':
+                args.append(data[p:p + v].decode(errors='replace'))
+                p += (v + 7) // 8 * 8
+            else:
+                args.append(v)
+        sys.stdout.write('[%d]%s' % (stamp * 1000 // FREQ, render(fmt, args)))
+        pos += size
+    if dropped:
+        print('(%d records dropped, log full)' % dropped)
+
+
+def main():
+    p = argparse.ArgumentParser(description='decode the boot0 binary log')
+    p.add_argument('elf', help='boot0.elf of the boot0 that wrote the log')
+    p.add_argument('log', help='dump of CONFIG_BOOT0_BLOG_BASE')
+    args = p.parse_args()
+
+    with open(args.elf, 'rb') as fp:
+        image = Image(fp.read())
+    with open(args.log, 'rb') as fp:
+        decode(image, fp.read())
+
+
+if __name__ == '__main__':
+    main()
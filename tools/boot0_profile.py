@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: GPL-2.0+
+#
+# Symbolize the samples of a boot0 built with CFG_BOOT0_PROFILE=y, from a
+# UART log of a boot where 'p' was sent to boot0 (the "profile:" lines).
+#
+#   boot0_profile.py boot.log boot0.elf
+#   boot0_profile.py -a boot.log boot0.map
+#
+# Samples are per 16 bytes of text, a bucket straddling two functions is
+# put on the one it starts in.
+
+import argparse
+import bisect
+import re
+import struct
+import sys
+
+
+def elf_symbols(data):
+    """(addr, name) of the functions and labels in an ELF64 symtab"""
+    if data[:4] != b'\x7fELF' or data[4] != 2:
+        sys.exit('not an ELF64 file')
+    shoff, = struct.unpack_from('<Q', data, 0x28)
+    shentsize, shnum = struct.unpack_from('<HH', data, 0x3a)
+    sections = [struct.unpack_from('<IIQQQQIIQQ', data, shoff + i * shentsize)
+                for i in range(shnum)]
+    syms = []
+    for sh in sections:
+        if sh[1] != 2:  # SHT_SYMTAB
+            continue
+        strtab = sections[sh[6]]
+        for off in range(sh[4], sh[4] + sh[5], sh[9]):
+            name, info, _, shndx, value, _ = struct.unpack_from('<IBBHQQ', data, off)
+            if info & 0xf not in (0, 2) or not shndx or not value:  # NOTYPE, FUNC
+                continue
+            s = data[strtab[4] + name:data.index(b'\0', strtab[4] + name)].decode()
+            if s and not s.startswith(('$', '.L')):
+                syms.append((value, s))
+    return syms
+
+
+def map_symbols(text):
+    """(addr, name) from a GNU ld map: global symbols, and .text.<function>
+    input sections for the static functions the map doesn't list"""
+    syms = []
+    section = None
+    for line in text.splitlines():
+        m = re.match(r'^ \.text\.(\S+)\s*(?:0x([0-9a-f]+)\s+0x[0-9a-f]+\s+\S+)?$', line)
+        if m:
+            section = m.group(1)
+            if m.group(2):
+                syms.append((int(m.group(2), 16), section))
+                section = None
+            continue
+        m = re.match(r'^\s+0x([0-9a-f]+)\s+0x[0-9a-f]+\s+\S+$', line)
+        if m and section:
+            syms.append((int(m.group(1), 16), section))
+        section = None
+        m = re.match(r'^\s+0x([0-9a-f]+)\s+([A-Za-z_][\w.]*)$', line)
+        if m:
+            syms.append((int(m.group(1), 16), m.group(2)))
+    return syms
+
+
+def read_samples(log):
+    hz, other, samples = None, 0, {}
+    for line in log.splitlines():
+        m = re.search(r'profile: hz (\d+) text ([0-9a-f]+) shift (\d+) other (\d+)', line)
+        if m:
+            hz, other, samples = int(m.group(1)), int(m.group(4)), {}
+            continue
+        m = re.search(r'profile: ([0-9a-f]+) (\d+)', line)
+        if m and hz:
+            samples[int(m.group(1), 16)] = int(m.group(2))
+    if not hz:
+        sys.exit('no profile in the log, was boot0 sent a p?')
+    return hz, other, samples
+
+
+def main():
+    p = argparse.ArgumentParser(description='symbolize boot0 profile samples')
+    p.add_argument('-a', '--addresses', action='store_true',
+                   help='list every sampled address, not just functions')
+    p.add_argument('log', help='UART log with the profile: lines')
+    p.add_argument('image', help='boot0.elf or boot0.map')
+    args = p.parse_args()
+
+    with open(args.log, 'rb') as fp:
+        hz, other, samples = read_samples(fp.read().decode(errors='replace'))
+    with open(args.image, 'rb') as fp:
+        data = fp.read()
+    syms = sorted(set(elf_symbols(data) if data[:4] == b'\x7fELF'
+                      else map_symbols(data.decode(errors='replace'))))
+    addrs = [a for a, _ in syms]
+
+    def symbolize(addr):
+        i = bisect.bisect_right(addrs, addr) - 1
+        return (syms[i][1], addr - syms[i][0]) if i >= 0 else ('?', addr)
+
+    total = sum(samples.values()) + other
+    if not total:
+        sys.exit('no samples')
+    funcs = {}
+    for addr, n in samples.items():
+        name = symbolize(addr)[0]
+        funcs[name] = funcs.get(name, 0) + n
+    if other:
+        funcs['(outside boot0)'] = other
+
+    print('%8s %6s %9s  %s' % ('samples', '%', 'ms', 'function'))
+    for name, n in sorted(funcs.items(), key=lambda f: -f[1]):
+        print('%8d %6.2f %9.1f  %s' % (n, n * 100.0 / total, n * 1000.0 / hz, name))
+    if args.addresses:
+        print()
+        for addr, n in sorted(samples.items(), key=lambda s: -s[1]):
+            name, off = symbolize(addr)
+            print('%8d %6.2f  %08x %s+0x%x' % (n, n * 100.0 / total, addr, name, off))
+
+
+if __name__ == '__main__':
+    main()
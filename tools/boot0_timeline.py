@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: GPL-2.0+
+#
+# Render the boot0 timeline (struct boot0_timeline, include/private_boot0.h).
+#
+#   boot0_timeline.py /proc/device-tree/chosen    # from the running kernel
+#   boot0_timeline.py board.dtb                   # DTB as boot0 handed it over
+#   boot0_timeline.py timeline.bin                # dump of CONFIG_BOOT0_TIMELINE_BASE
+#
+# Each line is a phase, as it ended in ms since reset and how long it took,
+# counting from the end of the phase before it.
+
+import argparse
+import os
+import struct
+import sys
+
+BOOT0_TIMELINE_MAGIC = 0x4c543042
+FDT_MAGIC = 0xd00dfeed
+FDT_BEGIN_NODE, FDT_END_NODE, FDT_PROP, FDT_NOP, FDT_END = 1, 2, 3, 4, 9
+
+
+def from_props(props):
+    freq = struct.unpack('>I', props['boot0,timer-frequency'])[0]
+    names = props['boot0,timing-names'].rstrip(b'\0').decode().split('\0')
+    cells = props['boot0,timings']
+    stamps = [hi << 32 | lo for hi, lo in struct.iter_unpack('>II', cells)]
+    return freq, list(zip(names, stamps))
+
+
+def from_dtb(data):
+    """properties of /chosen in a flattened device tree"""
+    (off_struct, off_strings) = struct.unpack_from('>II', data, 8)
+    pos, depth, path, props = off_struct, 0, [], {}
+    while True:
+        tag = struct.unpack_from('>I', data, pos)[0]
+        pos += 4
+        if tag == FDT_BEGIN_NODE:
+            end = data.index(b'\0', pos)
+            path.append(data[pos:end].decode())
+            pos = (end + 4) & ~3
+        elif tag == FDT_END_NODE:
+            path.pop()
+        elif tag == FDT_PROP:
+            size, nameoff = struct.unpack_from('>II', data, pos)
+            pos += 8
+            name = data[off_strings + nameoff:data.index(b'\0', off_strings + nameoff)]
+            if path == ['', 'chosen']:
+                props[name.decode()] = data[pos:pos + size]
+            pos = (pos + size + 3) & ~3
+        elif tag == FDT_END:
+            return props
+        elif tag != FDT_NOP:
+            sys.exit('bad DTB tag %d at %d' % (tag, pos - 4))
+
+
+def from_dir(path):
+    props = {}
+    for name in ('boot0,timer-frequency', 'boot0,timing-names', 'boot0,timings'):
+        with open(os.path.join(path, name), 'rb') as fp:
+            props[name] = fp.read()
+    return props
+
+
+def from_dump(data):
+    magic, count, freq, _ = struct.unpack_from('<IIII', data)
+    if magic != BOOT0_TIMELINE_MAGIC:
+        sys.exit('no boot0 timeline (magic 0x%08x)' % magic)
+    entries = []
+    for i in range(count):
+        stamp, name = struct.unpack_from('<Q16s', data, 16 + 24 * i)
+        entries.append((name.split(b'\0')[0].decode(), stamp))
+    return freq, entries
+
+
+def main():
+    p = argparse.ArgumentParser(description='render the boot0 timeline')
+    p.add_argument('source', help='/proc/device-tree/chosen, a DTB or a memory dump')
+    args = p.parse_args()
+
+    if os.path.isdir(args.source):
+        freq, entries = from_props(from_dir(args.source))
+    else:
+        with open(args.source, 'rb') as fp:
+            data = fp.read()
+        if struct.unpack_from('>I', data)[0] == FDT_MAGIC:
+            props = from_dtb(data)
+            if 'boot0,timings' not in props:
+                sys.exit('no /chosen/boot0,timings in %s' % args.source)
+            freq, entries = from_props(props)
+        else:
+            freq, entries = from_dump(data)
+
+    prev = 0
+    print('%-16s %10s %10s' % ('phase', 'at ms', 'took ms'))
+    for name, stamp in entries:
+        print('%-16s %10.3f %10.3f' % (name, stamp * 1e3 / freq, (stamp - prev) * 1e3 / freq))
+        prev = stamp
+
+
+if __name__ == '__main__':
+    main()
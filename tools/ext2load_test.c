@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * nboot/main/ext2load.c built for the host by ext2load_test.sh, loading
+ * the boot0.cfg of a disk image through load_ext2() as boot0 does. DRAM is
+ * an anonymous mapping at its boot0 address, mmc_bread() reads the image
+ * and counts the requests. Each <file> <addr> pair given after the image
+ * is then checked against what landed at addr.
+ *
+ *   ext2load_test [-m max sectors per read] image [file addr]...
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#define DRAM_BASE	0x40000000UL
+#define DRAM_SIZE	0x10000000UL
+
+static FILE *img;
+static unsigned max_run = 65535;
+static unsigned long nreads, nsect, pend;
+
+unsigned long mmc_bread(int dev, unsigned long start, unsigned cnt, void *dst)
+{
+	if (cnt > max_run) {
+		printf("FAIL read of %u sectors, more than %u\n", cnt, max_run);
+		return 0;
+	}
+	nreads++;
+	nsect += cnt;
+	if (fseek(img, start * 512L, SEEK_SET) || fread(dst, 512, cnt, img) != cnt)
+		return 0;
+	return cnt;
+}
+
+unsigned long mmc_bread_async(int dev, unsigned long start, unsigned cnt, void *dst)
+{
+	return pend = mmc_bread(dev, start, cnt, dst);
+}
+
+unsigned long mmc_wait(int dev)
+{
+	return pend;
+}
+
+unsigned mmc_bread_max(int dev)
+{
+	return max_run;
+}
+
+int sunxi_mmc_init(int sdc_no, unsigned bus_width, const void *gpio, int offset)
+{
+	return 0;
+}
+
+unsigned long malloc_mark(void)
+{
+	return 0;
+}
+
+void malloc_release(unsigned long mark)
+{
+}
+
+char BT0_head[4096];
+
+int load_ext2(uint64_t *uboot_base, uint64_t *optee_base, uint64_t *monitor_base,
+	      uint64_t *rtos_base, uint64_t *opensbi_base, uint64_t *dtb_base,
+	      char **cmdline);
+
+static int check(const char *path, unsigned long addr)
+{
+	FILE *f = fopen(path, "rb");
+	unsigned char *p = (unsigned char *)addr;
+	size_t i, n, off = 0;
+	unsigned char b[65536];
+
+	if (!f) {
+		perror(path);
+		return 1;
+	}
+	while ((n = fread(b, 1, sizeof(b), f)) > 0) {
+		if (memcmp(p + off, b, n)) {
+			for (i = 0; p[off + i] == b[i]; i++)
+				;
+			printf("FAIL %s differs at byte %zu\n", path, off + i);
+			fclose(f);
+			return 1;
+		}
+		off += n;
+	}
+	fclose(f);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	uint64_t base[6];
+	char *cmdline;
+	int i, opt, rc;
+
+	while ((opt = getopt(argc, argv, "m:")) != -1) {
+		if (opt != 'm')
+			return 2;
+		max_run = strtoul(optarg, NULL, 0);
+	}
+	if (optind >= argc || (argc - optind) % 2 != 1) {
+		fprintf(stderr, "usage: %s [-m max sectors per read] image [file addr]...\n", argv[0]);
+		return 2;
+	}
+	img = fopen(argv[optind], "rb");
+	if (!img) {
+		perror(argv[optind]);
+		return 2;
+	}
+	if (mmap((void *)DRAM_BASE, DRAM_SIZE, PROT_READ | PROT_WRITE,
+		 MAP_FIXED_NOREPLACE | MAP_PRIVATE | MAP_ANONYMOUS, -1, 0) != (void *)DRAM_BASE) {
+		perror("mmap");
+		return 2;
+	}
+	/* stale data, so that a block left unread does not pass for zeroes */
+	memset((void *)DRAM_BASE, 0xa5, DRAM_SIZE);
+
+	rc = load_ext2(&base[0], &base[1], &base[2], &base[3], &base[4], &base[5], &cmdline);
+	if (rc) {
+		printf("FAIL load_ext2 returned %d\n", rc);
+		return 1;
+	}
+	for (i = optind + 1; i < argc; i += 2)
+		if (check(argv[i], strtoul(argv[i + 1], NULL, 0)))
+			return 1;
+	printf("%lu reads, %lu sectors, %.1f sectors per read\n", nreads, nsect,
+	       (double)nsect / nreads);
+	return 0;
+}
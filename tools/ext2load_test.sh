@@ -0,0 +1,105 @@
+#!/bin/sh
+# SPDX-License-Identifier: GPL-2.0+
+#
+# Build tools/ext2load_test.c with nboot/main/ext2load.c for the host, then
+# load files out of ext2 and ext4 images made by mke2fs -d and check them,
+# from the top of the tree:
+#
+#   tools/ext2load_test.sh
+#
+# Each case prints the number of mmc reads it took. char is unsigned, as on
+# riscv.
+
+set -e
+: ${CC:=gcc}
+out=$(mktemp -d)
+trap 'rm -rf $out' EXIT
+
+{
+	echo "#ifndef _CONFIG_H_"
+	echo "#define _CONFIG_H_"
+	echo "#include<sun20iw1p1.h>"
+	echo "#define CFG_ARCH_RISCV 1"
+	echo "#define CFG_EXT2_LOADER 1"
+	echo "#define CFG_LOG_LEVEL 1"
+	echo "#endif"
+} >$out/config.h
+for f in nboot/main/ext2load.c common/crc32.c; do
+	$CC -c -O2 -fno-builtin -ffreestanding -D__KERNEL__ -D__riscv_xlen=64 -funsigned-char -w \
+		-I$out -Iinclude -Iinclude/arch/riscv -Iinclude/configs \
+		-Iinclude/arch/sun20iw1p1 -Iinclude/openssl \
+		$f -o $out/$(basename $f .c).o
+done
+$CC -O2 tools/ext2load_test.c $out/ext2load.o $out/crc32.o -o $out/ext2load_test
+
+# ext2 tree: a directory big enough for an htree index once e2fsck -D
+# has gone over it
+r2=$out/r2
+mkdir -p $r2/boot $r2/many
+head -c 123457 /dev/urandom >$r2/opensbi.bin
+head -c 34567 /dev/urandom >$r2/fdt
+head -c 20971523 /dev/urandom >$r2/boot/Image
+for i in $(seq 1 3000); do
+	echo $i >$r2/many/file_with_a_long_name_number_$i
+done
+printf 'file opensbi.bin 0x40000000\nfile fdt 0x40100000\nfile boot/Image 0x41000000\n' \
+	>$r2/boot0.cfg
+echo 'file many/file_with_a_long_name_number_2345 0x40110000' >>$r2/boot0.cfg
+files2="$r2/opensbi.bin 0x40000000 $r2/fdt 0x40100000 $r2/boot/Image 0x41000000"
+files2="$files2 $r2/many/file_with_a_long_name_number_2345 0x40110000"
+
+# ext4 tree adds sparse, with a hole before, between and after its 200 extents
+# (an extent tree of depth 1), and pre, whose hole the image gets an
+# unwritten extent for
+r4=$out/r4
+cp -a $r2 $r4
+for i in $(seq 0 199); do
+	head -c 4096 /dev/urandom |
+		dd of=$r4/sparse bs=4096 seek=$((i*16+1)) conv=notrunc status=none
+done
+truncate -s 14M $r4/sparse
+head -c 100000 /dev/urandom >$r4/pre
+head -c 100000 /dev/urandom | dd of=$r4/pre bs=1M seek=1 status=none
+printf 'file sparse 0x42800000\nfile pre 0x43800000\n' >>$r4/boot0.cfg
+files4="$files2 $r4/sparse 0x42800000 $r4/pre 0x43800000"
+files4=$(echo "$files4" | sed "s|$r2/|$r4/|g")
+
+# run <name> <max sectors per read> <mke2fs options>...
+run() {
+	name=$1 max=$2
+	shift 2
+	rm -f $out/part.img $out/disk.img
+	truncate -s 64M $out/part.img
+	case "$*" in
+	*ext4*)
+		root=$r4 files=$files4
+		;;
+	*)
+		root=$r2 files=$files2
+		;;
+	esac
+	mke2fs -q -F -d $root "$@" $out/part.img
+	bs=$(dumpe2fs -h $out/part.img 2>/dev/null | sed -n 's/^Block size: *//p')
+	e2fsck -fyD $out/part.img >/dev/null 2>&1 || [ $? = 1 ]
+	if [ $root = $r4 ]; then
+		debugfs -w -R "fallocate /pre $((131072/bs)) $((1048576/bs-1))" \
+			$out/part.img >/dev/null 2>&1
+	fi
+	# one bootable partition at sector 2048
+	truncate -s 1M $out/disk.img
+	cat $out/part.img >>$out/disk.img
+	printf '\200\000\000\000\203\000\000\000\000\010\000\000\000\000\002\000' |
+		dd of=$out/disk.img bs=1 seek=446 conv=notrunc status=none
+	printf '\125\252' | dd of=$out/disk.img bs=1 seek=510 conv=notrunc status=none
+	printf '%-24s' "$name"
+	$out/ext2load_test -m $max $out/disk.img $files
+}
+
+run "ext2 1k" 65535 -t ext2 -b 1024
+run "ext2 4k" 65535 -t ext2 -b 4096
+run "ext2 1k, 8 per read" 8 -t ext2 -b 1024
+run "ext2 4k, 24 per read" 24 -t ext2 -b 4096
+run "ext4 1k" 65535 -t ext4 -b 1024
+run "ext4 2k" 65535 -t ext4 -b 2048
+run "ext4 4k" 65535 -t ext4 -b 4096
+run "ext4 4k, 24 per read" 24 -t ext4 -b 4096
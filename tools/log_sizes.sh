@@ -0,0 +1,25 @@
+#!/bin/sh
+# SPDX-License-Identifier: GPL-2.0+
+#
+# Build a boot0 at each CFG_LOG_LEVEL and print what leaving out the
+# pr_debug()/pr_info()/... calls above it saves, from the top of the tree:
+#
+#   log_sizes.sh mmc|spinor|nand [make arguments]
+#
+# Every level is a full rebuild after make clean.
+
+target=$1
+shift
+case $target in
+mmc)	suffix=_sdcard ;;
+*)	suffix=_$target ;;
+esac
+
+full=
+for level in 4 3 2 1 0; do
+	${MAKE:-make} clean
+	${MAKE:-make} "$@" CFG_LOG_LEVEL=$level $target >/dev/null || exit 1
+	size=$(wc -c < nboot/boot0$suffix.bin)
+	[ -n "$full" ] || full=$size
+	printf "boot0%s log level %d: %6d bytes, %6d saved\n" $suffix $level $size $((full - size))
+done
@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: GPL-2.0+
+#
+# Build a TOC1 boot package as boot0 loads it (include/private_toc.h).
+#
+#   mktoc1.py -o boot_package.fex opensbi:fw_jump.bin:0x40000000 \
+#             dtb:board.dtb:0x44000000 u-boot:u-boot.bin:0x4a000000:lz4
+#
+# Each item is name:file:run_addr[:gz|lz4|lzma]. A compressed item is stored
+# compressed and boot0 decompresses it to run_addr, which needs the matching
+# CFG_SUNXI_GUNZIP/LZ4/LZMA in the boot0 build. lz4 uses the lz4 command.
+# Every item carries the sha256 of its data as stored, checked by a boot0
+# built with CFG_SUNXI_SHA256.
+
+import argparse
+import gzip
+import hashlib
+import lzma
+import struct
+import subprocess
+import sys
+
+TOC_MAIN_INFO_MAGIC = 0x89119800
+TOC_MAIN_INFO_END = 0x3b45494d
+TOC_ITEM_INFO_END = 0x3b454949
+STAMP_VALUE = 0x5F0A6C39
+ALIGN_SIZE = 4 * 1024
+
+COMP = {'': 0, 'gz': 1, 'lz4': 2, 'lzma': 3}
+
+# struct sbrom_toc1_head_info, struct sbrom_toc1_item_info
+HEAD_FMT = '<16sIIIIIIII3II'
+ITEM_FMT = '<64sIIIIIIII32s59II'
+HEAD_SIZE = struct.calcsize(HEAD_FMT)
+ITEM_SIZE = struct.calcsize(ITEM_FMT)
+
+
+def align(n, a):
+    return (n + a - 1) // a * a
+
+
+def compress(data, comp):
+    if comp == 'gz':
+        return gzip.compress(data, 9, mtime=0)
+    if comp == 'lzma':
+        # legacy .lzma with the size in the header, as lzmaBuffToBuffDecompress() wants
+        c = lzma.compress(data, format=lzma.FORMAT_ALONE,
+                          filters=[{'id': lzma.FILTER_LZMA1, 'preset': 9}])
+        return c[:5] + struct.pack('<Q', len(data)) + c[13:]
+    if comp == 'lz4':
+        # one frame of independent blocks, as ulz4fn() wants
+        return subprocess.run(['lz4', '-9', '-BI', '-c'], input=data,
+                              stdout=subprocess.PIPE, check=True).stdout
+    return data
+
+
+def main():
+    p = argparse.ArgumentParser(description='build a TOC1 boot package')
+    p.add_argument('-o', '--output', required=True)
+    p.add_argument('-n', '--name', default='sunxi-package')
+    p.add_argument('items', nargs='+', metavar='name:file:run_addr[:comp]')
+    args = p.parse_args()
+
+    items = []
+    for spec in args.items:
+        f = spec.split(':')
+        if len(f) not in (3, 4) or (len(f) == 4 and f[3] not in COMP):
+            sys.exit('bad item %s' % spec)
+        comp = f[3] if len(f) == 4 else ''
+        with open(f[1], 'rb') as fp:
+            raw = fp.read()
+        data = compress(raw, comp)
+        items.append((f[0], int(f[2], 0), comp, raw, data))
+        if comp:
+            print('%s: %d -> %d bytes (%s)' % (f[0], len(raw), len(data), comp))
+
+    # items are sector aligned so boot0 can read them straight to run_addr
+    offset = align(HEAD_SIZE + ITEM_SIZE * len(items), ALIGN_SIZE)
+    table = b''
+    body = b''
+    for name, run_addr, comp, raw, data in items:
+        table += struct.pack(ITEM_FMT, name.encode(), offset, len(data), 0, 3,
+                             run_addr, 0, COMP[comp], len(raw) if comp else 0,
+                             hashlib.sha256(data).digest(),
+                             *([0] * 59), TOC_ITEM_INFO_END)
+        body += data + b'\0' * (align(len(data), ALIGN_SIZE) - len(data))
+        offset += align(len(data), ALIGN_SIZE)
+
+    valid_len = offset
+
+    def head(add_sum):
+        return struct.pack(HEAD_FMT, args.name.encode(), TOC_MAIN_INFO_MAGIC,
+                           add_sum, 0, 0, len(items), valid_len, 0, 0,
+                           0, 0, 0, TOC_MAIN_INFO_END)
+
+    pkg = head(STAMP_VALUE) + table
+    pkg += b'\0' * (align(len(pkg), ALIGN_SIZE) - len(pkg)) + body
+    add_sum = sum(struct.unpack('<%dI' % (len(pkg) // 4), pkg)) & 0xffffffff
+    pkg = head(add_sum) + pkg[HEAD_SIZE:]
+
+    with open(args.output, 'wb') as fp:
+        fp.write(pkg)
+
+
+if __name__ == '__main__':
+    main()
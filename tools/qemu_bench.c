@@ -0,0 +1,607 @@
+/*
+ * SPDX-License-Identifier:	GPL-2.0+
+ *
+ * The bulk kernels of boot0 in a linux user program, built with the boot0
+ * sources and run under qemu-riscv64 by qemu_bench.sh, one section a run:
+ *
+ *	memops	memcpy/memmove/memset against a byte loop and libc
+ *	crc32	common/crc32.c byte at a time and sliced, against a bit loop
+ *	addsum	verify_addsum() then memcpy() against memcpy_addsum()
+ *	decode	the toc1 item decoders, on a file and its gz/lz4/lzma copies
+ *	vector	the RVV 1.0 kernels of rvv.S against their scalar versions
+ *
+ *   qemu_bench memops|crc32|addsum|vector
+ *   qemu_bench decode file file.gz file.lz4 file.lzma
+ *
+ * The memcpy/memmove/memset of arch/riscv/cpu/riscv64 are renamed boot0_*.
+ * Every kernel is checked before it is timed; the rates are qemu's, only
+ * good to compare.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef unsigned int u32;
+typedef unsigned long ulong;
+
+void *boot0_memcpy(void *dst, const void *src, size_t n);
+void *boot0_memmove(void *dst, const void *src, size_t n);
+void *boot0_memset(void *s, int c, size_t n);
+u32 memcpy_addsum(void *dst, const void *src, u32 size, u32 sum);
+
+u32 add_sum_update(u32 sum, const void *buf, u32 size);
+int verify_addsum(void *mem_base, u32 size);
+void crc32_init(void);
+u32 crc32(u32 crc, const unsigned char *buf, unsigned int len);
+int gunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp);
+int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn);
+int lzmaBuffToBuffDecompress(unsigned char *out, size_t *outn, unsigned char *in, size_t inn);
+
+void *rvv_memcpy(void *dst, const void *src, size_t n);
+void *rvv_memset(void *s, int c, size_t n);
+u32 rvv_addsum(u32 sum, const void *buf, u32 size);
+void rvv_dram_fill(u32 *addr, u32 patt, ulong n);
+u32 rvv_dram_check(const u32 *addr, u32 patt, ulong n);
+
+/* get_uart_input() in boot_utils.c */
+int sunxi_serial_tstc(void)
+{
+	return 0;
+}
+
+char sunxi_serial_getc(void)
+{
+	return 0;
+}
+
+#define AREA		(4 << 20)	/* largest case of any section */
+#define PER_CASE	(32 << 20)	/* bytes per timed case */
+
+static unsigned char *src_buf, *dst_buf, *ref_buf;
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* fresh src_buf, dst_buf and ref_buf equal over their first n bytes */
+static void fill(size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++)
+		src_buf[i] = rand();
+	memcpy(dst_buf, src_buf + 7, n - 7);
+	memcpy(ref_buf, dst_buf, n);
+}
+
+/* MB/s of call repeated over PER_CASE bytes, n bytes a call */
+#define TIME(call) ({						\
+	size_t k_, reps_ = PER_CASE / n + 1;			\
+	double t_ = now();					\
+	for (k_ = 0; k_ < reps_; k_++)				\
+		call;						\
+	reps_ * n / (now() - t_) / 1e6;				\
+})
+
+/*
+ * memops: boot0 memcpy/memmove/memset against a byte loop, what
+ * memcpy_sunxi.c did for any misaligned pair, and libc, over sizes and
+ * dst/src alignments
+ */
+
+#define MEMOPS_AREA	(256 << 10)
+
+static void *byte_memcpy(void *dst, const void *src, size_t n)
+{
+	unsigned char *d = dst;
+	const unsigned char *s = src;
+
+	while (n--)
+		*d++ = *s++;
+	return dst;
+}
+
+static void *byte_memmove(void *dst, const void *src, size_t n)
+{
+	unsigned char *d = dst;
+	const unsigned char *s = src;
+
+	if (d <= s)
+		return byte_memcpy(dst, src, n);
+	while (n--)
+		d[n] = s[n];
+	return dst;
+}
+
+static void *byte_memset(void *s, int c, size_t n)
+{
+	unsigned char *d = s;
+
+	while (n--)
+		*d++ = c;
+	return s;
+}
+
+typedef void *(*copy_fn)(void *, const void *, size_t);
+
+static int check_copy(const char *name, copy_fn fn, copy_fn ref, long dst_off, long src_off,
+		      size_t n)
+{
+	fill(MEMOPS_AREA);
+	ref(ref_buf + dst_off, (src_off < 0 ? ref_buf - src_off : src_buf + src_off), n);
+	if (fn(dst_buf + dst_off, (src_off < 0 ? dst_buf - src_off : src_buf + src_off), n) !=
+	    dst_buf + dst_off || memcmp(dst_buf, ref_buf, MEMOPS_AREA)) {
+		printf("FAIL %s n %zu dst %ld src %ld\n", name, n, dst_off, src_off);
+		return 1;
+	}
+	return 0;
+}
+
+static int memops(int argc, char **argv)
+{
+	static const size_t sizes[] = { 8, 15, 32, 63, 100, 256, 1000, 4096, 65536 };
+	static const int aligns[][2] = { { 0, 0 }, { 0, 3 }, { 5, 0 }, { 3, 6 }, { 1, 1 } };
+	unsigned i, j;
+	int c, fail = 0;
+
+	printf("%-8s %6s %3s %3s %10s %10s %10s\n", "op", "size", "dst", "src",
+	       "boot0 MB/s", "bytes", "libc");
+	for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		size_t n = sizes[i];
+
+		for (j = 0; j < sizeof(aligns) / sizeof(aligns[0]); j++) {
+			int da = aligns[j][0], sa = aligns[j][1];
+			unsigned char *d = dst_buf + 64 + da, *s = src_buf + 64 + sa;
+			/* memmove where dst is a little past src, the backward case */
+			unsigned char *ov = dst_buf + 4096 + sa, *od = ov + 24 - sa + da;
+
+			fail |= check_copy("memcpy", boot0_memcpy, byte_memcpy, 64 + da, 64 + sa, n);
+			fail |= check_copy("memmove", boot0_memmove, byte_memmove, 4096 + 24 + da,
+					   -(4096 + sa), n);
+			fail |= check_copy("memmove", boot0_memmove, byte_memmove, 4096 + da,
+					   -(4096 + 24 + sa), n);
+			if (fail)
+				return 1;
+
+			printf("%-8s %6zu %3d %3d %10.1f %10.1f %10.1f\n", "memcpy", n, da, sa,
+			       TIME(boot0_memcpy(d, s, n)), TIME(byte_memcpy(d, s, n)),
+			       TIME(memcpy(d, s, n)));
+			printf("%-8s %6zu %3d %3d %10.1f %10.1f %10.1f\n", "memmove", n, da, sa,
+			       TIME(boot0_memmove(od, ov, n)), TIME(byte_memmove(od, ov, n)),
+			       TIME(memmove(od, ov, n)));
+		}
+		for (j = 0; j < 8; j += 3) {
+			unsigned char *d = dst_buf + 64 + j;
+
+			for (c = 0; c < 256; c += 0x5a) {
+				fill(MEMOPS_AREA);
+				byte_memset(ref_buf + 64 + j, c, n);
+				if (boot0_memset(d, c, n) != d ||
+				    memcmp(dst_buf, ref_buf, MEMOPS_AREA)) {
+					printf("FAIL memset n %zu dst %u c %d\n", n, j, c);
+					return 1;
+				}
+			}
+			printf("%-8s %6zu %3u %3s %10.1f %10.1f %10.1f\n", "memset", n, j, "-",
+			       TIME(boot0_memset(d, 0, n)), TIME(byte_memset(d, 0, n)),
+			       TIME(memset(d, 0, n)));
+		}
+	}
+	return 0;
+}
+
+/*
+ * crc32: the check values first, then random buffers against a bit at a
+ * time crc, whole and chained over random splits from unaligned starts,
+ * byte at a time and once crc32_init() has built the slicing tables
+ */
+
+static u32 bit_crc32(u32 crc, const unsigned char *p, size_t n)
+{
+	int k;
+
+	crc = ~crc;
+	while (n--) {
+		crc ^= *p++;
+		for (k = 0; k < 8; k++)
+			crc = (crc >> 1) ^ (0xedb88320 & -(crc & 1));
+	}
+	return ~crc;
+}
+
+static int crc32_check(const char *what)
+{
+	static const struct {
+		const char *s;
+		u32 crc;
+	} vectors[] = {
+		{ "", 0 },
+		{ "a", 0xe8b7be43 },
+		{ "123456789", 0xcbf43926 },
+		{ "The quick brown fox jumps over the lazy dog", 0x414fa339 },
+	};
+	size_t i, off, n, pos, step;
+	u32 ref, c;
+
+	for (i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++) {
+		c = crc32(0, (const unsigned char *)vectors[i].s, strlen(vectors[i].s));
+		if (c != vectors[i].crc) {
+			printf("FAIL %s \"%s\" %08x, expected %08x\n", what, vectors[i].s,
+			       c, vectors[i].crc);
+			return 1;
+		}
+	}
+	if (crc32(0x12345678, NULL, 0) != 0) {
+		printf("FAIL %s NULL buffer\n", what);
+		return 1;
+	}
+
+	for (i = 0; i < 2000; i++) {
+		off = rand() % 8;
+		n = i < 300 ? i : rand() % (64 << 10);
+		ref = bit_crc32(0, src_buf + off, n);
+		if (crc32(0, src_buf + off, n) != ref) {
+			printf("FAIL %s whole n %zu off %zu\n", what, n, off);
+			return 1;
+		}
+		/* chained over random splits, each piece from wherever it falls */
+		for (pos = 0, c = 0; pos < n; pos += step) {
+			step = rand() % 3000 + 1;
+			if (step > n - pos)
+				step = n - pos;
+			c = crc32(c, src_buf + off + pos, step);
+		}
+		if (c != ref) {
+			printf("FAIL %s chained n %zu off %zu\n", what, n, off);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static void crc32_time(const char *what)
+{
+	static const size_t sizes[] = { 16, 64, 1024, 4096, 65536, 1 << 20 };
+	size_t i, n;
+	u32 c = 0;
+
+	for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		n = sizes[i];
+		printf("%-6s %8zu %10.1f MB/s\n", what, n, TIME(c = crc32(c, src_buf + 1, n)));
+	}
+	if (c == 0x12345678)
+		printf("\n");
+}
+
+static int crc32_bench(int argc, char **argv)
+{
+	if (crc32_check("byte"))
+		return 1;
+	crc32_time("byte");
+	crc32_init();
+	if (crc32_check("slice"))
+		return 1;
+	crc32_time("slice");
+	return 0;
+}
+
+/*
+ * addsum: the two ways boot0 can check a package and move its items,
+ * verify_addsum() over it then memcpy() of the items, reading it twice,
+ * against memcpy_addsum(), which sums what it copies. memcpy_addsum() is
+ * checked against add_sum_update() and a byte copy first, over sizes,
+ * alignments and chained calls.
+ */
+
+#define GUARD		16
+#define ADD_SUM		20		/* offset of add_sum in the toc1 head */
+#define STAMP_VALUE	0x5F0A6C39
+
+static int addsum_check(void)
+{
+	size_t i, so, d, n, pos, step;
+	u32 s, ref, sum;
+
+	for (i = 0; i < 3000; i++) {
+		so = rand() % 8;
+		d = rand() % 8;
+		n = i < 300 ? i : rand() % (64 << 10);
+		s = rand();
+		memset(dst_buf, 0x5a, n + d + GUARD);
+		ref = add_sum_update(s, src_buf + so, n);
+		sum = memcpy_addsum(dst_buf + d, src_buf + so, n, s);
+		if (sum != ref || memcmp(dst_buf + d, src_buf + so, n)) {
+			printf("FAIL n %zu src +%zu dst +%zu: sum %08x, expected %08x%s\n",
+			       n, so, d, sum, ref,
+			       memcmp(dst_buf + d, src_buf + so, n) ? ", copy differs" : "");
+			return 1;
+		}
+		for (pos = 0; pos < n + d + GUARD; pos++)
+			if ((pos < d || pos >= n + d) && dst_buf[pos] != 0x5a)
+				break;
+		if (pos < n + d + GUARD) {
+			printf("FAIL n %zu src +%zu dst +%zu: wrote outside the copy\n", n, so, d);
+			return 1;
+		}
+		/* chained over whole words, as load_toc1_staged() goes item by item */
+		for (pos = 0, sum = s; pos < n; pos += step) {
+			step = (rand() % 3000 + 1) & ~3;
+			if (step == 0 || step > n - pos)
+				step = n - pos;
+			sum = memcpy_addsum(dst_buf + d + pos, src_buf + so + pos, step, sum);
+		}
+		if (sum != ref || memcmp(dst_buf + d, src_buf + so, n)) {
+			printf("FAIL chained n %zu src +%zu dst +%zu\n", n, so, d);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/* make src_buf a package of n bytes whose head sum verify_addsum() accepts */
+static u32 package(size_t n)
+{
+	u32 sum;
+
+	memcpy(src_buf + ADD_SUM, &(u32){ STAMP_VALUE }, 4);
+	sum = add_sum_update(0, src_buf, n);
+	memcpy(src_buf + ADD_SUM, &sum, 4);
+	return sum;
+}
+
+static int addsum_time(size_t d)
+{
+	static const size_t sizes[] = { 4096, 65536, 1 << 20, AREA };
+	size_t i, n;
+	u32 src_sum;
+	int bad = 0;
+	double t1, t2;
+
+	for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		n = sizes[i];
+		src_sum = package(n);
+		t1 = TIME((bad |= verify_addsum(src_buf, n), boot0_memcpy(dst_buf + d, src_buf, n)));
+		t2 = TIME((memcpy(src_buf + ADD_SUM, &(u32){ STAMP_VALUE }, 4),
+			   bad |= memcpy_addsum(dst_buf + d, src_buf, n, 0) != src_sum,
+			   memcpy(src_buf + ADD_SUM, &src_sum, 4)));
+		if (bad) {
+			printf("FAIL package sum n %zu\n", n);
+			return 1;
+		}
+		printf("dst +%zu %8zu  sum+copy %8.1f MB/s  memcpy_addsum %8.1f MB/s  %.2fx\n",
+		       d, n, t1, t2, t2 / t1);
+	}
+	return 0;
+}
+
+static int addsum(int argc, char **argv)
+{
+	if (addsum_check())
+		return 1;
+	/* run_addr aligned as items are, then misaligned */
+	if (addsum_time(0) || addsum_time(3))
+		return 1;
+	return 0;
+}
+
+/*
+ * decode: each decoder checked against the original file, then timed;
+ * qemu_bench.sh runs it with and without CFG_RISCV_XTHEAD
+ */
+
+static unsigned char *read_file(const char *name, size_t *len)
+{
+	FILE *fp = fopen(name, "rb");
+	unsigned char *buf;
+	long n;
+
+	if (!fp || fseek(fp, 0, SEEK_END) || (n = ftell(fp)) < 0) {
+		perror(name);
+		exit(1);
+	}
+	rewind(fp);
+	buf = malloc(n + 1);
+	if (fread(buf, 1, n, fp) != (size_t)n) {
+		perror(name);
+		exit(1);
+	}
+	fclose(fp);
+	*len = n;
+	return buf;
+}
+
+static int decode_one(int kind, unsigned char *out, size_t n, unsigned char *in, size_t in_len)
+{
+	unsigned long gz_len = in_len;
+	size_t out_len = n;
+
+	switch (kind) {
+	case 0:
+		return gunzip(out, n, in, &gz_len) || gz_len != n;
+	case 1:
+		return ulz4fn(in, in_len, out, &out_len) || out_len != n;
+	default:
+		return lzmaBuffToBuffDecompress(out, &out_len, in, in_len) || out_len != n;
+	}
+}
+
+static int decode(int argc, char **argv)
+{
+	static const char *const names[] = { "gunzip", "lz4", "lzma" };
+	unsigned char *raw, *out;
+	size_t n;
+	int kind;
+
+	if (argc != 5) {
+		fprintf(stderr, "usage: qemu_bench decode file file.gz file.lz4 file.lzma\n");
+		return 1;
+	}
+	crc32_init();
+	raw = read_file(argv[1], &n);
+	out = malloc(n + 1);
+
+	for (kind = 0; kind < 3; kind++) {
+		size_t in_len;
+		unsigned char *in = read_file(argv[2 + kind], &in_len);
+
+		memset(out, 0, n);
+		if (decode_one(kind, out, n, in, in_len) || memcmp(out, raw, n)) {
+			printf("FAIL %s\n", names[kind]);
+			return 1;
+		}
+		printf("%-8s %8zu -> %8zu %8.2f MB/s\n", names[kind], in_len, n,
+		       TIME(decode_one(kind, out, n, in, in_len)));
+		free(in);
+	}
+	return 0;
+}
+
+/*
+ * vector: the RVV 1.0 build of rvv.S against the scalar boot0 memcpy,
+ * memset and add_sum_update() and the loops of dramc_simple_wr_test(),
+ * over sizes and alignments. The c906 build, rvv_thead.S, needs the
+ * board: qemu has no RVV 0.7.1.
+ */
+
+#define VECTOR_AREA	(256 << 10)
+
+static void c_dram_fill(u32 *addr, u32 patt, ulong n)
+{
+	ulong i;
+
+	for (i = 0; i != n; i++)
+		((volatile u32 *)addr)[i] = patt + i;
+}
+
+static u32 c_dram_check(const u32 *addr, u32 patt, ulong n)
+{
+	ulong i;
+
+	for (i = 0; i != n; i++)
+		if (((volatile u32 *)addr)[i] != patt + i)
+			return 1;
+	return 0;
+}
+
+static int vector_check(size_t n)
+{
+	int da, sa, c;
+	u32 patt, *w = (u32 *)(dst_buf + 64);
+	size_t words = n / 4;
+
+	for (da = 0; da < 8; da += 3) {
+		for (sa = 0; sa < 8; sa += 5) {
+			fill(VECTOR_AREA);
+			memcpy(ref_buf + 64 + da, src_buf + 64 + sa, n);
+			if (rvv_memcpy(dst_buf + 64 + da, src_buf + 64 + sa, n) != dst_buf + 64 + da ||
+			    memcmp(dst_buf, ref_buf, VECTOR_AREA)) {
+				printf("FAIL memcpy n %zu dst %d src %d\n", n, da, sa);
+				return 1;
+			}
+		}
+		for (c = 0; c < 256; c += 0x5a) {
+			fill(VECTOR_AREA);
+			memset(ref_buf + 64 + da, c, n);
+			if (rvv_memset(dst_buf + 64 + da, c, n) != dst_buf + 64 + da ||
+			    memcmp(dst_buf, ref_buf, VECTOR_AREA)) {
+				printf("FAIL memset n %zu dst %d c %d\n", n, da, c);
+				return 1;
+			}
+		}
+	}
+
+	patt = rand();
+	if (rvv_addsum(patt, src_buf + 64, n) != add_sum_update(patt, src_buf + 64, n)) {
+		printf("FAIL addsum n %zu\n", n);
+		return 1;
+	}
+
+	fill(VECTOR_AREA);
+	c_dram_fill((u32 *)(ref_buf + 64), patt, words);
+	rvv_dram_fill(w, patt, words);
+	if (memcmp(dst_buf, ref_buf, VECTOR_AREA) || rvv_dram_check(w, patt, words)) {
+		printf("FAIL dram_fill n %zu\n", n);
+		return 1;
+	}
+	if (words) {
+		w[rand() % words] ^= 1u << (rand() % 32);
+		if (!rvv_dram_check(w, patt, words)) {
+			printf("FAIL dram_check n %zu\n", n);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static int vector(int argc, char **argv)
+{
+	static const size_t sizes[] = { 1, 31, 256, 1000, 4096, 65536 };
+	unsigned i;
+
+	for (i = 0; i < 4096; i += i < 300 ? 1 : 97)
+		if (vector_check(i))
+			return 1;
+	for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+		if (vector_check(sizes[i]))
+			return 1;
+
+	printf("%-10s %6s %10s %10s\n", "op", "size", "rvv MB/s", "scalar");
+	for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		size_t n = sizes[i];
+		u32 *w = (u32 *)dst_buf, patt = 0x01234567, s = 0, bad = 0;
+
+		printf("%-10s %6zu %10.1f %10.1f\n", "memcpy", n,
+		       TIME(rvv_memcpy(dst_buf, src_buf + 3, n)),
+		       TIME(boot0_memcpy(dst_buf, src_buf + 3, n)));
+		printf("%-10s %6zu %10.1f %10.1f\n", "memset", n,
+		       TIME(rvv_memset(dst_buf, 0, n)),
+		       TIME(boot0_memset(dst_buf, 0, n)));
+		printf("%-10s %6zu %10.1f %10.1f\n", "addsum", n,
+		       TIME(s += rvv_addsum(s, src_buf, n)),
+		       TIME(s += add_sum_update(s, src_buf, n)));
+		printf("%-10s %6zu %10.1f %10.1f\n", "dram_fill", n,
+		       TIME(rvv_dram_fill(w, patt, n / 4)),
+		       TIME(c_dram_fill(w, patt, n / 4)));
+		printf("%-10s %6zu %10.1f %10.1f\n", "dram_check", n,
+		       TIME(bad |= rvv_dram_check(w, patt, n / 4)),
+		       TIME(bad |= c_dram_check(w, patt, n / 4)));
+		if (bad)
+			return 1;
+	}
+	return 0;
+}
+
+static const struct {
+	const char *name;
+	int (*run)(int argc, char **argv);
+} sections[] = {
+	{ "memops", memops },
+	{ "crc32", crc32_bench },
+	{ "addsum", addsum },
+	{ "decode", decode },
+	{ "vector", vector },
+};
+
+int main(int argc, char **argv)
+{
+	size_t i;
+
+	src_buf = aligned_alloc(64, AREA + 64);
+	dst_buf = aligned_alloc(64, AREA + 64);
+	ref_buf = aligned_alloc(64, AREA + 64);
+	for (i = 0; i < AREA + 64; i++)
+		src_buf[i] = rand();
+
+	for (i = 0; argc > 1 && i < sizeof(sections) / sizeof(sections[0]); i++)
+		if (!strcmp(argv[1], sections[i].name))
+			return sections[i].run(argc - 1, argv + 1);
+	fprintf(stderr, "usage: %s memops|crc32|addsum|vector\n"
+		"       %s decode file file.gz file.lz4 file.lzma\n", argv[0], argv[0]);
+	return 2;
+}
@@ -0,0 +1,126 @@
+#!/bin/sh
+# SPDX-License-Identifier: GPL-2.0+
+#
+# Build tools/qemu_bench.c with the boot0 kernels it checks and times and
+# run its sections under qemu-riscv64 user mode, from the top of the tree:
+#
+#   CROSS_COMPILE=riscv64-linux-musl- tools/qemu_bench.sh [-c cpu] [-f file] \
+#	[-v vlens] [memops|crc32|addsum|decode|vector]...
+#
+# With no section given, all of them run, decode only if -f is. memops,
+# crc32 and addsum run on cpu, e.g. thead-c906, qemu's default otherwise.
+# decode compresses file as tools/mktoc1.py does and runs once for plain
+# rv64gc and once with CFG_RISCV_XTHEAD, on cpu, thead-c906 otherwise: the
+# only one that runs the second build. vector runs the RVV 1.0 kernels at
+# each of vlens, "128 256 512" otherwise; the c906 ones are only assembled,
+# to catch errors.
+
+set -e
+: ${CROSS_COMPILE:=riscv64-linux-musl-}
+cpu= file= vlens="128 256 512"
+while getopts c:f:v: opt; do
+	case $opt in
+	c) cpu=$OPTARG ;;
+	f) file=$OPTARG ;;
+	v) vlens=$OPTARG ;;
+	*) exit 2 ;;
+	esac
+done
+shift $((OPTIND - 1))
+sections=${*:-memops crc32 addsum ${file:+decode} vector}
+for section in $sections; do
+	case $section in
+	memops|crc32|addsum|decode|vector) ;;
+	*)
+		echo "unknown section $section" >&2
+		exit 2
+		;;
+	esac
+done
+case " $sections " in
+*" decode "*)
+	if [ -z "$file" ]; then
+		echo "decode needs -f file" >&2
+		exit 2
+	fi
+	variants="rv64gc xthead"
+	;;
+*)
+	variants=rv64gc
+	;;
+esac
+out=$(mktemp -d)
+trap 'rm -rf $out' EXIT
+
+mkdir $out/asm
+: > $out/asm/config.h
+for f in memcpy memset memcpy_addsum rvv rvv_thead; do
+	${CROSS_COMPILE}gcc -c -march=rv64gc -mabi=lp64d -D__ASSEMBLY__ \
+		-I$out/asm -Iinclude/arch/riscv -Dmemcpy=boot0_memcpy \
+		-Dmemmove=boot0_memmove -Dmemset=boot0_memset \
+		arch/riscv/cpu/riscv64/$f.S -o $out/asm/$f.o
+done
+
+for variant in $variants; do
+	mkdir $out/$variant
+	march=rv64gc
+	{
+		echo "#ifndef _CONFIG_H_"
+		echo "#define _CONFIG_H_"
+		echo "#include<sun20iw1p1.h>"
+		echo "#define CFG_ARCH_RISCV 1"
+		echo "#define CFG_SUNXI_GUNZIP 1"
+		echo "#define CFG_SUNXI_LZ4 1"
+		echo "#define CFG_SUNXI_LZMA 1"
+		if [ $variant = xthead ]; then
+			echo "#define CFG_RISCV_XTHEAD 1"
+			march=rv64gc_xtheadba_xtheadbb_xtheadcondmov_xtheadmemidx
+		fi
+		echo "#endif"
+	} >$out/$variant/config.h
+	for src in common/boot_utils.c common/crc32.c common/gunzip.c \
+		   common/zlib/zlib.c common/lz4/lz4_wrapper.c \
+		   common/lzma/LzmaDec.c common/lzma/LzmaTools.c; do
+		${CROSS_COMPILE}gcc -c -Os -ffunction-sections -fno-builtin -ffreestanding \
+			-D__KERNEL__ -march=$march -mabi=lp64d -I$out/$variant -Iinclude \
+			-Iinclude/arch/riscv -Iinclude/configs -Iinclude/arch/sun20iw1p1 \
+			-Iinclude/openssl $src -o $out/$variant/$(basename $src .c).o
+	done
+	${CROSS_COMPILE}gcc -O2 -static -fno-tree-loop-distribute-patterns \
+		-Wl,--gc-sections tools/qemu_bench.c $out/$variant/*.o \
+		$out/asm/memcpy.o $out/asm/memset.o $out/asm/memcpy_addsum.o \
+		$out/asm/rvv.o -o $out/$variant/qemu_bench
+done
+
+if [ -n "$file" ]; then
+	python3 - "$file" "$out" <<'PY'
+import sys
+sys.path.insert(0, 'tools')
+import mktoc1
+data = open(sys.argv[1], 'rb').read()
+for comp in ('gz', 'lz4', 'lzma'):
+    open('%s/data.%s' % (sys.argv[2], comp), 'wb').write(mktoc1.compress(data, comp))
+PY
+fi
+
+for section in $sections; do
+	case $section in
+	memops|crc32|addsum)
+		echo "$section:"
+		qemu-riscv64 ${cpu:+-cpu $cpu} $out/rv64gc/qemu_bench $section
+		;;
+	decode)
+		for variant in $variants; do
+			echo "decode $variant:"
+			qemu-riscv64 -cpu ${cpu:-thead-c906} $out/$variant/qemu_bench decode \
+				$file $out/data.gz $out/data.lz4 $out/data.lzma
+		done
+		;;
+	vector)
+		for vlen in $vlens; do
+			echo "vector vlen $vlen:"
+			qemu-riscv64 -cpu rv64,v=true,vlen=$vlen $out/rv64gc/qemu_bench vector
+		done
+		;;
+	esac
+done